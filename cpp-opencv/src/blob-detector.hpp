@@ -0,0 +1,275 @@
+/* Title: Blob Detector - single-pass connected components on binary masks
+ * Authors: Nasit Vurgun, Sam Hardingham, Kai Rowley, Daniel van den Heuvel
+ * Institution: University of Gothenburg, Sweden
+ * Course: DIT638/DIT639 (2024), taught by Prof. Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BLOB_DETECTOR_HPP
+#define BLOB_DETECTOR_HPP
+
+#include <opencv2/core/core.hpp>
+
+#include <algorithm> // For std::partial_sort, std::min, std::max
+#include <cstddef>   // For std::size_t
+#include <cstdint>   // For fixed width integers
+#include <cstring>   // For std::memcpy
+#include <utility>   // For std::swap
+#include <vector>    // For the pre-allocated storage
+
+// 8-connected region of non-zero pixels in a mask.
+struct Blob
+{
+    cv::Rect rect;       // bounding rect
+    int32_t area;        // number of pixels
+    cv::Point2f centroid;
+    int32_t first;       // raster index (y * cols + x) of the first pixel
+};
+
+// Orders blobs by bounding rect area (as the original contour search did). Ties are broken like
+// the first-found maximum of the original scan: cv::findContours(..., RETR_TREE, ...) lists the
+// outermost regions in reverse raster order of their first pixel, each before its holes and the
+// regions inside them (which have smaller bounding rects), so the region starting last wins.
+inline bool isLargerBlob(const Blob &a, const Blob &b)
+{
+    const int32_t areaA = a.rect.width * a.rect.height;
+    const int32_t areaB = b.rect.width * b.rect.height;
+    return (areaA != areaB) ? (areaA > areaB) : (a.first > b.first);
+}
+
+// Labels the 8-connected components of a CV_8UC1 mask in a single pass over its rows.
+// Each row is decomposed into runs of non-zero pixels; runs touching a run of the previous
+// row (including diagonally) are merged with union-find while bounding box, pixel count and
+// coordinate sums are accumulated per label. The storage grows to the worst case of the
+// largest mask seen and is reused afterwards, so detect() does not allocate per frame.
+//
+// The components are the same regions cv::findContours(..., RETR_TREE, ...) returns as outer
+// contours, and their bounding rects are identical to cv::boundingRect() of those contours.
+class BlobDetector
+{
+public:
+    BlobDetector()
+        : m_previousRuns(), m_currentRuns(), m_parent(), m_stats(), m_blobs()
+    {
+    }
+
+    // Pre-allocates the storage for masks of up to rows x cols pixels.
+    BlobDetector(int rows, int cols)
+        : BlobDetector()
+    {
+        reserve(rows, cols);
+    }
+
+    void reserve(int rows, int cols)
+    {
+        const std::size_t runsPerRow = static_cast<std::size_t>(cols + 1) / 2;
+        const std::size_t runs = runsPerRow * static_cast<std::size_t>(rows);
+        m_previousRuns.reserve(runsPerRow);
+        m_currentRuns.reserve(runsPerRow);
+        m_parent.reserve(runs);
+        m_stats.reserve(runs);
+        m_blobs.reserve(runs);
+    }
+
+    // Finds all blobs in mask; the result stays valid until the next call.
+    const std::vector<Blob> &detect(const cv::Mat &mask)
+    {
+        reserve(mask.rows, mask.cols);
+        m_previousRuns.clear();
+        m_parent.clear();
+        m_stats.clear();
+        m_blobs.clear();
+
+        for (int y = 0; y < mask.rows; y++)
+        {
+            const uint8_t *row = mask.ptr<uint8_t>(y);
+            m_currentRuns.clear();
+            std::size_t candidate = 0;
+
+            int x = 0;
+            while (x < mask.cols)
+            {
+                x = skipZeros(row, x, mask.cols);
+                if (x >= mask.cols)
+                {
+                    break;
+                }
+                const int start = x;
+                x = skipNonZeros(row, x, mask.cols);
+                const int end = x - 1;
+
+                // Runs of the previous row are sorted; the ones ending left of start - 1 cannot touch this or later runs.
+                while ((candidate < m_previousRuns.size()) && (m_previousRuns[candidate].end < start - 1))
+                {
+                    candidate++;
+                }
+                int32_t label = -1;
+                for (std::size_t i = candidate; (i < m_previousRuns.size()) && (m_previousRuns[i].start <= end + 1); i++)
+                {
+                    const int32_t other = find(m_previousRuns[i].label);
+                    label = (label < 0) ? other : merge(label, other);
+                }
+                if (label < 0)
+                {
+                    label = static_cast<int32_t>(m_parent.size());
+                    m_parent.push_back(label);
+                    m_stats.push_back(Stats{start, end, y, y, 0, 0, 0, y * mask.cols + start});
+                }
+                addRun(m_stats[static_cast<std::size_t>(label)], start, end, y);
+                m_currentRuns.push_back(Run{start, end, label});
+            }
+            m_previousRuns.swap(m_currentRuns);
+        }
+
+        for (std::size_t label = 0; label < m_parent.size(); label++)
+        {
+            if (m_parent[label] == static_cast<int32_t>(label))
+            {
+                const Stats &s = m_stats[label];
+                const double area = static_cast<double>(s.area);
+                m_blobs.push_back(Blob{cv::Rect(s.minX, s.minY, s.maxX - s.minX + 1, s.maxY - s.minY + 1),
+                                       static_cast<int32_t>(s.area),
+                                       cv::Point2f(static_cast<float>(static_cast<double>(s.sumX) / area), static_cast<float>(static_cast<double>(s.sumY) / area)),
+                                       s.first});
+            }
+        }
+        return m_blobs;
+    }
+
+    // Moves the k largest blobs (by bounding rect area) to the front of blobs(), largest first;
+    // returns how many there are (at most k).
+    std::size_t topK(std::size_t k)
+    {
+        const std::size_t count = std::min(k, m_blobs.size());
+        std::partial_sort(m_blobs.begin(), m_blobs.begin() + static_cast<std::ptrdiff_t>(count), m_blobs.end(), isLargerBlob);
+        return count;
+    }
+
+    const std::vector<Blob> &blobs() const
+    {
+        return m_blobs;
+    }
+
+private:
+    struct Run
+    {
+        int start;
+        int end;
+        int32_t label;
+    };
+
+    struct Stats
+    {
+        int minX;
+        int maxX;
+        int minY;
+        int maxY;
+        int64_t area;
+        int64_t sumX;
+        int64_t sumY;
+        int32_t first;
+    };
+
+    static uint64_t loadWord(const uint8_t *p)
+    {
+        uint64_t word;
+        std::memcpy(&word, p, sizeof(word));
+        return word;
+    }
+
+    static int skipZeros(const uint8_t *row, int x, int cols)
+    {
+        while ((x + 8 <= cols) && (0 == loadWord(row + x)))
+        {
+            x += 8;
+        }
+        while ((x < cols) && (0 == row[x]))
+        {
+            x++;
+        }
+        return x;
+    }
+
+    static int skipNonZeros(const uint8_t *row, int x, int cols)
+    {
+        // Masks from inRange() contain 0 or 255 only, so full words of 0xFF are skipped at once.
+        while ((x + 8 <= cols) && (~UINT64_C(0) == loadWord(row + x)))
+        {
+            x += 8;
+        }
+        while ((x < cols) && (0 != row[x]))
+        {
+            x++;
+        }
+        return x;
+    }
+
+    static void addRun(Stats &s, int start, int end, int y)
+    {
+        const int64_t length = end - start + 1;
+        s.minX = std::min(s.minX, start);
+        s.maxX = std::max(s.maxX, end);
+        s.maxY = std::max(s.maxY, y);
+        s.area += length;
+        // (start + end) * length is always even, so the sum of the x coordinates is exact.
+        s.sumX += (start + end) * length / 2;
+        s.sumY += length * y;
+    }
+
+    int32_t find(int32_t label)
+    {
+        while (m_parent[static_cast<std::size_t>(label)] != label)
+        {
+            // Path halving keeps the trees flat.
+            const int32_t grandParent = m_parent[static_cast<std::size_t>(m_parent[static_cast<std::size_t>(label)])];
+            m_parent[static_cast<std::size_t>(label)] = grandParent;
+            label = grandParent;
+        }
+        return label;
+    }
+
+    // Merges two root labels; the statistics are kept at the returned root.
+    int32_t merge(int32_t a, int32_t b)
+    {
+        if (a == b)
+        {
+            return a;
+        }
+        if (b < a)
+        {
+            std::swap(a, b);
+        }
+        Stats &root = m_stats[static_cast<std::size_t>(a)];
+        const Stats &child = m_stats[static_cast<std::size_t>(b)];
+        root.minX = std::min(root.minX, child.minX);
+        root.maxX = std::max(root.maxX, child.maxX);
+        root.minY = std::min(root.minY, child.minY);
+        root.maxY = std::max(root.maxY, child.maxY);
+        root.area += child.area;
+        root.sumX += child.sumX;
+        root.sumY += child.sumY;
+        root.first = std::min(root.first, child.first);
+        m_parent[static_cast<std::size_t>(b)] = a;
+        return a;
+    }
+
+    std::vector<Run> m_previousRuns;
+    std::vector<Run> m_currentRuns;
+    std::vector<int32_t> m_parent;
+    std::vector<Stats> m_stats;
+    std::vector<Blob> m_blobs;
+};
+
+#endif
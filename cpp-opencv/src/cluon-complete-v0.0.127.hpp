@@ -6083,6 +6083,149 @@ class LIBCLUON_API TerminateHandler {
 };
 } // namespace cluon
 
+#endif
+/*
+ * Copyright (C) 2017-2018  Christian Berger
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CLUON_MPSCRINGBUFFER_HPP
+#define CLUON_MPSCRINGBUFFER_HPP
+
+//#include "cluon/cluon.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace cluon {
+
+/**
+ * This class provides a bounded, lock-free FIFO for several producer threads
+ * and one consumer thread. Every slot carries a sequence number that tells
+ * whether it is free for the producer or filled for the consumer of the
+ * current round (D. Vyukov's bounded queue); producers claim slots with a
+ * compare-and-swap on the write counter. A producer may also pop() to
+ * discard the oldest entry when the ring buffer is full.
+ *
+ * Entries are moved in and out; T needs to be default-constructible and
+ * move-assignable only.
+ */
+template <class T>
+class LIBCLUON_API MPSCRingBuffer {
+   private:
+    MPSCRingBuffer(const MPSCRingBuffer &) = delete;
+    MPSCRingBuffer(MPSCRingBuffer &&)      = delete;
+    MPSCRingBuffer &operator=(const MPSCRingBuffer &) = delete;
+    MPSCRingBuffer &operator=(MPSCRingBuffer &&) = delete;
+
+   public:
+    /**
+     * Constructor.
+     *
+     * @param capacity Maximum number of entries; rounded up to a power of two (at least 2).
+     */
+    explicit MPSCRingBuffer(std::size_t capacity) noexcept {
+        std::size_t slots{2};
+        while (slots < capacity) {
+            slots <<= 1;
+        }
+        m_mask  = slots - 1;
+        m_slots = std::unique_ptr<Slot[]>(new Slot[slots]);
+        for (std::size_t i{0}; i < slots; i++) {
+            m_slots[i].m_sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @return Maximum number of entries.
+     */
+    std::size_t capacity() const noexcept {
+        return m_mask + 1;
+    }
+
+    /**
+     * @return true if there are no entries (a snapshot when called concurrently).
+     */
+    bool empty() const noexcept {
+        const std::size_t READ{m_read.load(std::memory_order_seq_cst)};
+        return m_slots[READ & m_mask].m_sequence.load(std::memory_order_seq_cst) != READ + 1;
+    }
+
+    /**
+     * @param entry Entry to append; only moved from if it was appended.
+     * @return true if the entry was appended, false if the ring buffer is full.
+     */
+    bool push(T &entry) noexcept {
+        std::size_t write{m_write.load(std::memory_order_relaxed)};
+        while (true) {
+            Slot &slot = m_slots[write & m_mask];
+            const std::size_t SEQUENCE{slot.m_sequence.load(std::memory_order_acquire)};
+            const std::ptrdiff_t DIFFERENCE{static_cast<std::ptrdiff_t>(SEQUENCE) - static_cast<std::ptrdiff_t>(write)};
+            if (0 == DIFFERENCE) {
+                if (m_write.compare_exchange_weak(write, write + 1, std::memory_order_relaxed)) {
+                    slot.m_entry = std::move(entry);
+                    slot.m_sequence.store(write + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (0 > DIFFERENCE) {
+                // The slot still holds the entry of the previous round.
+                return false;
+            } else {
+                write = m_write.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @param entry Oldest entry, moved out of the ring buffer.
+     * @return true if an entry was available.
+     */
+    bool pop(T &entry) noexcept {
+        std::size_t read{m_read.load(std::memory_order_relaxed)};
+        while (true) {
+            Slot &slot = m_slots[read & m_mask];
+            const std::size_t SEQUENCE{slot.m_sequence.load(std::memory_order_acquire)};
+            const std::ptrdiff_t DIFFERENCE{static_cast<std::ptrdiff_t>(SEQUENCE) - static_cast<std::ptrdiff_t>(read + 1)};
+            if (0 == DIFFERENCE) {
+                if (m_read.compare_exchange_weak(read, read + 1, std::memory_order_relaxed)) {
+                    entry = std::move(slot.m_entry);
+                    slot.m_sequence.store(read + m_mask + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (0 > DIFFERENCE) {
+                return false;
+            } else {
+                read = m_read.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+   private:
+    struct Slot {
+        std::atomic<std::size_t> m_sequence{0};
+        T m_entry{};
+    };
+
+    // The counters are written by different threads; keep them on separate cache lines.
+    static constexpr std::size_t CACHE_LINE{64};
+
+    std::unique_ptr<Slot[]> m_slots{};
+    std::size_t m_mask{0};
+    char m_padding0[CACHE_LINE]{};
+    std::atomic<std::size_t> m_write{0};
+    char m_padding1[CACHE_LINE]{};
+    std::atomic<std::size_t> m_read{0};
+    char m_padding2[CACHE_LINE]{};
+};
+
+} // namespace cluon
+
 #endif
 /*
  * Copyright (C) 2017-2018  Christian Berger
@@ -6096,16 +6239,28 @@ class LIBCLUON_API TerminateHandler {
 #define CLUON_NOTIFYINGPIPELINE_HPP
 
 //#include "cluon/cluon.hpp"
+//#include "cluon/MPSCRingBuffer.hpp"
 
 #include <atomic>
 #include <condition_variable>
-#include <deque>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <mutex>
 #include <thread>
 
 namespace cluon {
 
+/**
+ * This class runs a delegate in its own thread for every entry that
+ * producers add(); producers call notifyAll() after adding one or more
+ * entries to wake up that thread. The entries are passed through a bounded,
+ * lock-free MPSCRingBuffer; what happens when it is full is decided by the
+ * OverflowPolicy:
+ * - DROP_OLDEST discards the oldest waiting entry to make room (default),
+ * - DROP_NEWEST discards the entry being added, and
+ * - BLOCK lets the producer wait until the delegate has taken an entry.
+ */
 template <class T>
 class LIBCLUON_API NotifyingPipeline {
    private:
@@ -6115,8 +6270,27 @@ class LIBCLUON_API NotifyingPipeline {
     NotifyingPipeline &operator=(NotifyingPipeline &&) = delete;
 
    public:
-    NotifyingPipeline(std::function<void(T &&)> delegate)
-        : m_delegate(delegate) {
+    enum class OverflowPolicy : uint8_t { DROP_OLDEST, DROP_NEWEST, BLOCK };
+
+    static constexpr std::size_t DEFAULT_CAPACITY{8192};
+
+   public:
+    /**
+     * Constructor.
+     *
+     * @param delegate Functional to process an entry.
+     * @param capacity Maximum number of waiting entries; rounded up to a power of two.
+     * @param overflowPolicy What add() does when capacity entries are waiting.
+     * @param droppedDelegate Functional called from add() with every entry that is dropped (optional).
+     */
+    NotifyingPipeline(std::function<void(T &&)> delegate,
+                      std::size_t capacity                      = DEFAULT_CAPACITY,
+                      OverflowPolicy overflowPolicy             = OverflowPolicy::DROP_OLDEST,
+                      std::function<void(T &&)> droppedDelegate = nullptr)
+        : m_delegate(std::move(delegate))
+        , m_droppedDelegate(std::move(droppedDelegate))
+        , m_overflowPolicy(overflowPolicy)
+        , m_pipeline(capacity) {
         m_pipelineThread = std::thread(&NotifyingPipeline::processPipeline, this);
 
         // Let the operating system spawn the thread.
@@ -6128,7 +6302,11 @@ class LIBCLUON_API NotifyingPipeline {
         m_pipelineThreadRunning.store(false);
 
         // Wake any waiting threads.
-        m_pipelineCondition.notify_all();
+        {
+            std::lock_guard<std::mutex> lck(m_pipelineMutex);
+            m_pipelineCondition.notify_all();
+            m_spaceCondition.notify_all();
+        }
 
         // Joining the thread could fail.
         try {
@@ -6139,65 +6317,140 @@ class LIBCLUON_API NotifyingPipeline {
     }
 
    public:
-    inline void add(T &&entry) noexcept {
+    /**
+     * This method adds an entry; it is processed after the next call to notifyAll().
+     *
+     * @param entry Entry to add.
+     * @return true if the entry was added, false if it was dropped (DROP_NEWEST, or BLOCK during destruction).
+     */
+    inline bool add(T &&entry) noexcept {
+        m_added.fetch_add(1, std::memory_order_relaxed);
+        if (m_pipeline.push(entry)) {
+            return true;
+        }
+
+        if (OverflowPolicy::DROP_NEWEST == m_overflowPolicy) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            if (nullptr != m_droppedDelegate) {
+                m_droppedDelegate(std::move(entry));
+            }
+            return false;
+        }
+
+        if (OverflowPolicy::DROP_OLDEST == m_overflowPolicy) {
+            T oldest;
+            do {
+                if (m_pipeline.pop(oldest)) {
+                    m_dropped.fetch_add(1, std::memory_order_relaxed);
+                    if (nullptr != m_droppedDelegate) {
+                        m_droppedDelegate(std::move(oldest));
+                    }
+                }
+            } while (!m_pipeline.push(entry));
+            return true;
+        }
+
+        // BLOCK: the delegate's thread might still be waiting for the notification of the entries added so far.
+        notifyAll();
         std::unique_lock<std::mutex> lck(m_pipelineMutex);
-        m_pipeline.emplace_back(entry);
+        m_waitingProducers.fetch_add(1);
+        bool added{false};
+        while (!(added = m_pipeline.push(entry)) && m_pipelineThreadRunning.load()) {
+            m_spaceCondition.wait(lck);
+        }
+        m_waitingProducers.fetch_sub(1);
+        if (!added) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed); // LCOV_EXCL_LINE
+            if (nullptr != m_droppedDelegate) {                // LCOV_EXCL_LINE
+                m_droppedDelegate(std::move(entry));           // LCOV_EXCL_LINE
+            }
+        }
+        return added;
     }
 
-    inline void notifyAll() noexcept { m_pipelineCondition.notify_all(); }
+    inline void notifyAll() noexcept {
+        // Only take the mutex if the delegate's thread is (about to go) asleep; see processPipeline().
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_consumerSleeping.load()) {
+            std::lock_guard<std::mutex> lck(m_pipelineMutex);
+            m_pipelineCondition.notify_all();
+        }
+    }
 
     inline bool isRunning() noexcept { return m_pipelineThreadRunning.load(); }
 
+    /**
+     * @return Maximum number of waiting entries.
+     */
+    inline std::size_t capacity() const noexcept { return m_pipeline.capacity(); }
+
+    /**
+     * @return Number of entries passed to add().
+     */
+    inline uint64_t added() const noexcept { return m_added.load(std::memory_order_relaxed); }
+
+    /**
+     * @return Number of entries that were discarded because the pipeline was full.
+     */
+    inline uint64_t dropped() const noexcept { return m_dropped.load(std::memory_order_relaxed); }
+
+    /**
+     * @return Number of entries that were passed to the delegate.
+     */
+    inline uint64_t processed() const noexcept { return m_processed.load(std::memory_order_relaxed); }
+
    private:
     inline void processPipeline() noexcept {
         // Indicate to caller that we are ready.
         m_pipelineThreadRunning.store(true);
 
+        T entry;
         while (m_pipelineThreadRunning.load()) {
-            std::unique_lock<std::mutex> lck(m_pipelineMutex);
-            // Wait until the thread should stop or data is available.
-            m_pipelineCondition.wait(lck, [this] { return (!this->m_pipelineThreadRunning.load() || !this->m_pipeline.empty()); });
-
-            // The condition will automatically lock the mutex after waking up.
-            // As we are locking per entry, we need to unlock the mutex first.
-            lck.unlock();
-
-            uint32_t entries{0};
             {
-                lck.lock();
-                entries = static_cast<uint32_t>(m_pipeline.size());
-                lck.unlock();
+                std::unique_lock<std::mutex> lck(m_pipelineMutex);
+                // Announce the sleep before checking for entries: a producer either sees
+                // the flag in notifyAll() or its entry is seen here.
+                m_consumerSleeping.store(true);
+                m_pipelineCondition.wait(lck, [this] { return (!this->m_pipelineThreadRunning.load() || !this->m_pipeline.empty()); });
+                m_consumerSleeping.store(false);
             }
-            for (uint32_t i{0}; i < entries; i++) {
-                T entry;
-                {
-                    lck.lock();
-                    entry = m_pipeline.front();
-                    lck.unlock();
+
+            while (m_pipeline.pop(entry)) {
+                // Like in notifyAll(): either a blocked producer sees the free slot or it is woken up here.
+                if (OverflowPolicy::BLOCK == m_overflowPolicy) {
+                    std::atomic_thread_fence(std::memory_order_seq_cst);
+                }
+                if (0 < m_waitingProducers.load()) {
+                    std::lock_guard<std::mutex> lck(m_pipelineMutex);
+                    m_spaceCondition.notify_all();
                 }
 
                 if (nullptr != m_delegate) {
                     m_delegate(std::move(entry));
                 }
-
-                {
-                    lck.lock();
-                    m_pipeline.pop_front();
-                    lck.unlock();
-                }
+                m_processed.fetch_add(1, std::memory_order_relaxed);
             }
         }
     }
 
    private:
     std::function<void(T &&)> m_delegate;
+    std::function<void(T &&)> m_droppedDelegate;
+    const OverflowPolicy m_overflowPolicy;
 
     std::atomic<bool> m_pipelineThreadRunning{false};
     std::thread m_pipelineThread{};
     std::mutex m_pipelineMutex{};
     std::condition_variable m_pipelineCondition{};
+    std::condition_variable m_spaceCondition{};
+    std::atomic<bool> m_consumerSleeping{false};
+    std::atomic<uint32_t> m_waitingProducers{0};
+
+    std::atomic<uint64_t> m_added{0};
+    std::atomic<uint64_t> m_dropped{0};
+    std::atomic<uint64_t> m_processed{0};
 
-    std::deque<T> m_pipeline{};
+    MPSCRingBuffer<T> m_pipeline;
 };
 } // namespace cluon
 
@@ -6408,6 +6661,15 @@ cluon::UDPReceiver receiver("127.0.0.1", 1234,
     });
 \endcode
 
+Receivers that do not need the human-readable sender can instead pass a delegate
+`std::function<void(std::string &&, const struct sockaddr_in &, std::chrono::system_clock::time_point &&)>`,
+which gets the sender's address as it was received and saves formatting it
+for every packet.
+
+On Linux, the receiving thread sleeps in epoll until data arrives (or the
+UDPReceiver is destroyed) and reads up to 32 packets per system call using
+recvmmsg; the kernel's receive time stamps are delivered alongside the data.
+
 After creating an instance of class `cluon::UDPReceiver`, it is immediately
 activated and concurrently waiting for data in a separate thread. To check
 whether the instance was created successfully and running, the method
@@ -6436,6 +6698,19 @@ class LIBCLUON_API UDPReceiver {
                 uint16_t receiveFromPort,
                 std::function<void(std::string &&, std::string &&, std::chrono::system_clock::time_point &&)> delegate,
                 uint16_t localSendFromPort = 0) noexcept;
+
+    /**
+     * Constructor.
+     *
+     * @param receiveFromAddress Numerical IPv4 address to receive UDP packets from.
+     * @param receiveFromPort Port to receive UDP packets from.
+     * @param delegate Functional (noexcept) to handle received bytes; parameters are received data, sender's address, timestamp.
+     * @param localSendFromPort Port that an application is using to send data. This port (> 0) is ignored when data is received.
+     */
+    UDPReceiver(const std::string &receiveFromAddress,
+                uint16_t receiveFromPort,
+                std::function<void(std::string &&, const struct sockaddr_in &, std::chrono::system_clock::time_point &&)> delegate,
+                uint16_t localSendFromPort = 0) noexcept;
     ~UDPReceiver() noexcept;
 
     /**
@@ -6451,10 +6726,39 @@ class LIBCLUON_API UDPReceiver {
      */
     void closeSocket(int errorCode) noexcept;
 
+    /**
+     * This method creates, configures, and binds the socket and starts the
+     * receiving thread; it is shared by both constructors.
+     */
+    void open(const std::string &receiveFromAddress, uint16_t receiveFromPort) noexcept;
+
     void readFromSocket() noexcept;
 
+    bool hasDelegate() const noexcept;
+
+    /**
+     * @return Human-readable representation X.Y.Z.W:ABCD of the given sender; the last one is cached.
+     */
+    const std::string &senderToString(const struct sockaddr_in &sender) noexcept;
+
+#ifdef __linux__
+    /**
+     * This method creates the epoll instance that watches the socket and an
+     * eventfd to wake up the receiving thread on destruction.
+     *
+     * @return true if the receiving thread can use readFromSocketBatched().
+     */
+    bool createEventLoop() noexcept;
+
+    void readFromSocketBatched() noexcept;
+#endif
+
    private:
     int32_t m_socket{-1};
+#ifdef __linux__
+    int32_t m_epollFD{-1};
+    int32_t m_wakeUpFD{-1};
+#endif
     bool m_isBlockingSocket{true};
     std::set<unsigned long> m_listOfLocalIPAddresses{};
     uint16_t m_localSendFromPort;
@@ -6467,12 +6771,17 @@ class LIBCLUON_API UDPReceiver {
 
    private:
     std::function<void(std::string &&, std::string &&, std::chrono::system_clock::time_point)> m_delegate{};
+    std::function<void(std::string &&, const struct sockaddr_in &, std::chrono::system_clock::time_point &&)> m_delegateWithAddress{};
+
+    // Only used from the pipeline's thread.
+    struct sockaddr_in m_lastSender {};
+    std::string m_lastSenderAsString{};
 
    private:
     class PipelineEntry {
        public:
         std::string m_data;
-        std::string m_from;
+        struct sockaddr_in m_from;
         std::chrono::system_clock::time_point m_sampleTime;
     };
 
@@ -8145,91 +8454,1038 @@ inline T extractMessage(cluon::data::Envelope &&envelope) noexcept {
  * file, You can obtain one at http://mozilla.org/MPL/2.0/.
  */
 
-#ifndef CLUON_ENVELOPECONVERTER_HPP
-#define CLUON_ENVELOPECONVERTER_HPP
+#ifndef CLUON_RECFILEVIEW_HPP
+#define CLUON_RECFILEVIEW_HPP
 
-//#include "cluon/MetaMessage.hpp"
 //#include "cluon/cluon.hpp"
 //#include "cluon/cluonDataStructures.hpp"
+//#include "cluon/FromProtoVisitor.hpp"
 
+// clang-format off
+#ifndef WIN32
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+// clang-format on
+
+#include <cstddef>
 #include <cstdint>
-#include <map>
+#include <fstream>
+#include <istream>
+#include <iterator>
+#include <streambuf>
 #include <string>
-#include <vector>
+#include <utility>
 
 namespace cluon {
+
 /**
-This class provides various conversion functions to and from Envelope data structures.
-*/
-class LIBCLUON_API EnvelopeConverter {
+ * This class provides a read-only std::streambuf on top of an existing
+ * memory area so that it can be decoded with an std::istream without
+ * copying it into an std::string first.
+ */
+class LIBCLUON_API MemoryStreamBuffer : public std::streambuf {
    private:
-    EnvelopeConverter(const EnvelopeConverter &) = delete;
-    EnvelopeConverter(EnvelopeConverter &&)      = delete;
-    EnvelopeConverter &operator=(const EnvelopeConverter &) = delete;
-    EnvelopeConverter &operator=(EnvelopeConverter &&) = delete;
+    MemoryStreamBuffer(const MemoryStreamBuffer &) = delete;
+    MemoryStreamBuffer(MemoryStreamBuffer &&)      = delete;
+    MemoryStreamBuffer &operator=(MemoryStreamBuffer &&) = delete;
+    MemoryStreamBuffer &operator=(const MemoryStreamBuffer &other) = delete;
 
    public:
-    EnvelopeConverter() = default;
+    MemoryStreamBuffer(const char *data, std::size_t length) noexcept
+        : std::streambuf() {
+        // The get area is never written to.
+        char *begin = const_cast<char *>(data);
+        setg(begin, begin, begin + length);
+    }
+};
 
-    /**
-     * This method sets the message specification to be used for
-     * interpreting a given Proto-encoded Envelope.
-     *
-     * @param ms Message specification following the ODVD format.
-     * @return -1 in case of invalid message specification; otherwise, number
-     *         of successfully parsed messages from given message specification.
-     */
-    int32_t setMessageSpecification(const std::string &ms) noexcept;
+/**
+ * This class maps a file read-only into memory (or reads it completely
+ * where memory mapping is not available).
+ */
+class LIBCLUON_API MappedFile {
+   private:
+    MappedFile(const MappedFile &) = delete;
+    MappedFile(MappedFile &&)      = delete;
+    MappedFile &operator=(MappedFile &&) = delete;
+    MappedFile &operator=(const MappedFile &other) = delete;
 
+   public:
     /**
-     * This method transforms the given Proto-encoded Envelope to JSON. The
-     * Proto-encoded envelope might be preceded with a 5-bytes OD4-header (optional).
+     * Constructor.
      *
-     * @param protoEncodedEnvelope Proto-encoded Envelope.
-     * @return JSON representation from given Proto-encoded Envelope using the
-     *         given message specification.
+     * @param file File to map.
      */
-    std::string getJSONFromProtoEncodedEnvelope(const std::string &protoEncodedEnvelope) noexcept;
+    explicit MappedFile(const std::string &file) noexcept
+        : m_data(nullptr)
+        , m_size(0)
+        , m_valid(false)
+        , m_buffer() {
+#ifndef WIN32
+        const int fd = ::open(file.c_str(), O_RDONLY);
+        if (-1 != fd) {
+            struct stat info;
+            if (0 == ::fstat(fd, &info)) {
+                m_size  = static_cast<uint64_t>(info.st_size);
+                m_valid = true;
+                if (0 < m_size) {
+                    void *mapping = ::mmap(nullptr, static_cast<std::size_t>(m_size), PROT_READ, MAP_PRIVATE, fd, 0);
+                    if (MAP_FAILED != mapping) {
+                        // Files are mostly read front to back.
+                        ::madvise(mapping, static_cast<std::size_t>(m_size), MADV_SEQUENTIAL);
+                        m_data = static_cast<const char *>(mapping);
+                    } else {
+                        m_size  = 0;
+                        m_valid = false;
+                    }
+                }
+            }
+            ::close(fd);
+        }
+#else
+        std::ifstream in(file.c_str(), std::ios_base::in | std::ios_base::binary);
+        if (in.good()) {
+            m_buffer.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+            m_data  = m_buffer.data();
+            m_size  = m_buffer.size();
+            m_valid = true;
+        }
+#endif
+    }
+
+    ~MappedFile() {
+#ifndef WIN32
+        if (nullptr != m_data) {
+            ::munmap(const_cast<char *>(m_data), static_cast<std::size_t>(m_size));
+        }
+#endif
+    }
 
     /**
-     * This method transforms the given Envelope to JSON.
-     *
-     * @param envelope Envelope.
-     * @return JSON representation from given Envelope using the given message specification.
+     * @return true if the file could be opened (an empty file is valid).
      */
-    std::string getJSONFromEnvelope(cluon::data::Envelope &envelope) noexcept;
+    bool valid() const noexcept {
+        return m_valid;
+    }
 
     /**
-     * This method transforms a given JSON representation into a Proto-encoded Envelope
-     * including the prepended OD4-header.
-     *
-     * @param json representation according to the given message specification.
-     * @param messageIdentifier The given JSON representation shall be interpreted
-     *        as the specified message.
-     * @param senderStamp to be used in the Envelope.
-     * @return Proto-encoded Envelope including OD4-header or empty string.
+     * @return Size of the file in bytes.
      */
-    std::string getProtoEncodedEnvelopeFromJSONWithoutTimeStamps(const std::string &json, int32_t messageIdentifier, uint32_t senderStamp) noexcept;
+    uint64_t size() const noexcept {
+        return m_size;
+    }
 
     /**
-     * This method transforms a given JSON representation into a Proto-encoded Envelope
-     * including the prepended OD4-header and setting cluon::time::now() as sampleTimeStamp.
-     *
-     * @param json representation according to the given message specification.
-     * @param messageIdentifier The given JSON representation shall be interpreted
-     *        as the specified message.
-     * @param senderStamp to be used in the Envelope.
-     * @return Proto-encoded Envelope including OD4-header or empty string.
+     * @return Pointer to the mapped bytes.
      */
-    std::string getProtoEncodedEnvelopeFromJSON(const std::string &json, int32_t messageIdentifier, uint32_t senderStamp) noexcept;
+    const char *data() const noexcept {
+        return m_data;
+    }
 
    private:
-// clang-format off
-    std::string getProtoEncodedEnvelopeFromJSON(const std::string &json, int32_t messageIdentifier, uint32_t senderStamp, cluon::data::TimeStamp sampleTimeStamp) noexcept;
-// clang-format on
+    const char *m_data;
+    uint64_t m_size;
+    bool m_valid;
+    std::string m_buffer; // File contents if memory mapping is not available.
+};
 
-   private:
-    std::vector<cluon::MetaMessage> m_listOfMetaMessages{};
+/**
+ * This class describes one Envelope in a buffer, such as a .rec file that is
+ * accessed through a MappedRecFile or a received UDP packet. The Envelope's
+ * fields are decoded directly from the buffer, and its payload is only
+ * located; the Envelope itself and its payload are decoded on demand.
+ *
+ * A view is only valid as long as the buffer it was obtained from.
+ */
+class LIBCLUON_API EnvelopeView {
+   public:
+    enum : uint8_t { OD4_HEADER_SIZE = 5 };
+
+   public:
+    /**
+     * This method decodes the framing
+     *
+     *    0x0D 0xA4 LEN0 LEN1 LEN2 Proto-encoded cluon::data::Envelope
+     *
+     * and the fields of the Envelope at the given address without allocating.
+     *
+     * @param data Address of the 0x0D 0xA4 header.
+     * @param size Number of bytes available at data.
+     * @param view EnvelopeView to fill.
+     * @return true if there is a complete and well-formed Envelope at data.
+     */
+    static bool decode(const char *data, std::size_t size, EnvelopeView &view) noexcept {
+        if ((nullptr == data) || (size < OD4_HEADER_SIZE)) {
+            return false;
+        }
+        const uint8_t *header = reinterpret_cast<const uint8_t *>(data);
+        if ((0x0D != header[0]) || (0xA4 != header[1])) {
+            return false;
+        }
+        const uint32_t LENGTH{static_cast<uint32_t>(header[2]) | (static_cast<uint32_t>(header[3]) << 8) | (static_cast<uint32_t>(header[4]) << 16)};
+        if (size - OD4_HEADER_SIZE < LENGTH) {
+            return false;
+        }
+
+        view          = EnvelopeView();
+        view.m_length = LENGTH;
+        view.m_data   = data + OD4_HEADER_SIZE;
+        const bool retVal{decodeEnvelope(view.m_data, view.m_data + LENGTH, view)};
+        view.m_sampleTimeStamp = static_cast<int64_t>(view.m_sampleTime.seconds()) * static_cast<int64_t>(1000 * 1000)
+                                 + static_cast<int64_t>(view.m_sampleTime.microseconds());
+        return retVal;
+    }
+
+    /**
+     * @return The complete cluon::data::Envelope; the payload is the only field that is copied.
+     */
+    cluon::data::Envelope envelope() const noexcept {
+        cluon::data::Envelope env;
+        env.dataType(m_dataType).sent(m_sent).received(m_received).sampleTimeStamp(m_sampleTime).senderStamp(m_senderStamp);
+        // Fill serializedData in place instead of copying a temporary string.
+        PayloadAssigner payloadAssigner{m_payload, m_payloadLength};
+        env.accept(2, payloadAssigner);
+        return env;
+    }
+
+    /**
+     * @return A copy of the Envelope's serialized payload.
+     */
+    std::string serializedData() const noexcept {
+        return std::string(m_payload, m_payloadLength);
+    }
+
+    /**
+     * @return The payload decoded into the desired type without copying it first.
+     */
+    template <typename T>
+    T message() const noexcept {
+        MemoryStreamBuffer buffer(m_payload, m_payloadLength);
+        std::istream in(&buffer);
+        cluon::FromProtoVisitor decoder;
+        decoder.decodeFrom(in);
+
+        T msg;
+        msg.accept(decoder);
+        return msg;
+    }
+
+   public:
+    uint64_t m_filePosition{0};     // Position of the 0x0D 0xA4 header in the .rec file.
+    uint32_t m_length{0};           // Length of the Proto-encoded Envelope following the 5 header bytes.
+    int32_t m_dataType{0};
+    uint32_t m_senderStamp{0};
+    int64_t m_sampleTimeStamp{0};   // Sample time stamp in microseconds.
+    cluon::data::TimeStamp m_sent{};
+    cluon::data::TimeStamp m_received{};
+    cluon::data::TimeStamp m_sampleTime{};
+    const char *m_data{nullptr};    // Proto-encoded Envelope.
+    const char *m_payload{nullptr}; // Serialized payload (field serializedData) within m_data.
+    uint32_t m_payloadLength{0};
+
+   private:
+    /**
+     * Visitor that assigns the located payload to the Envelope's serializedData.
+     */
+    struct PayloadAssigner {
+        const char *m_payload;
+        std::size_t m_length;
+
+        template <typename T>
+        void visit(uint32_t, std::string &&, std::string &&, T &) noexcept {}
+        void visit(uint32_t, std::string &&, std::string &&, std::string &v) noexcept {
+            v.assign((nullptr == m_payload) ? "" : m_payload, m_length);
+        }
+    };
+
+   private:
+    static bool fromVarInt(const char *&p, const char *end, uint64_t &value) noexcept {
+        value = 0;
+        for (uint8_t shift{0}; (p < end) && (shift < 64); shift = static_cast<uint8_t>(shift + 7)) {
+            const uint8_t byte = static_cast<uint8_t>(*p++);
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (0 == (byte & 0x80)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static int32_t fromZigZag32(uint64_t v) noexcept {
+        const uint32_t u = static_cast<uint32_t>(v);
+        return static_cast<int32_t>((u >> 1) ^ (~(u & 1) + 1));
+    }
+
+    /**
+     * This method skips over one field with the given Proto wire type.
+     */
+    static bool skipField(const char *&p, const char *end, uint8_t wireType) noexcept {
+        uint64_t value{0};
+        switch (static_cast<ProtoConstants>(wireType)) {
+            case ProtoConstants::VARINT:
+                return fromVarInt(p, end, value);
+            case ProtoConstants::EIGHT_BYTES:
+                p += 8;
+                return p <= end;
+            case ProtoConstants::FOUR_BYTES:
+                p += 4;
+                return p <= end;
+            case ProtoConstants::LENGTH_DELIMITED:
+                if (fromVarInt(p, end, value) && (value <= static_cast<uint64_t>(end - p))) {
+                    p += value;
+                    return true;
+                }
+                return false;
+        }
+        return false;
+    }
+
+    /**
+     * This method decodes a Proto-encoded cluon::data::TimeStamp.
+     */
+    static bool decodeTimeStamp(const char *p, const char *end, cluon::data::TimeStamp &timeStamp) noexcept {
+        int32_t seconds{0};
+        int32_t micros{0};
+        while (p < end) {
+            uint64_t key{0};
+            uint64_t value{0};
+            if (!fromVarInt(p, end, key)) {
+                return false;
+            }
+            const uint8_t wireType = static_cast<uint8_t>(key & 0x7);
+            if ((static_cast<uint8_t>(ProtoConstants::VARINT) == wireType) && ((1 == (key >> 3)) || (2 == (key >> 3)))) {
+                if (!fromVarInt(p, end, value)) {
+                    return false;
+                }
+                ((1 == (key >> 3)) ? seconds : micros) = fromZigZag32(value);
+            } else if (!skipField(p, end, wireType)) {
+                return false;
+            }
+        }
+        timeStamp.seconds(seconds).microseconds(micros);
+        return true;
+    }
+
+    /**
+     * This method decodes the fields of a Proto-encoded cluon::data::Envelope;
+     * serializedData is only located.
+     */
+    static bool decodeEnvelope(const char *p, const char *end, EnvelopeView &view) noexcept {
+        while (p < end) {
+            uint64_t key{0};
+            uint64_t value{0};
+            if (!fromVarInt(p, end, key)) {
+                return false;
+            }
+            const uint32_t fieldId = static_cast<uint32_t>(key >> 3);
+            const uint8_t wireType = static_cast<uint8_t>(key & 0x7);
+            if (static_cast<uint8_t>(ProtoConstants::VARINT) == wireType && ((1 == fieldId) || (6 == fieldId))) {
+                if (!fromVarInt(p, end, value)) {
+                    return false;
+                }
+                if (1 == fieldId) {
+                    view.m_dataType = fromZigZag32(value);
+                } else {
+                    view.m_senderStamp = static_cast<uint32_t>(value);
+                }
+            } else if (static_cast<uint8_t>(ProtoConstants::LENGTH_DELIMITED) == wireType && (2 <= fieldId) && (fieldId <= 5)) {
+                if (!fromVarInt(p, end, value) || (value > static_cast<uint64_t>(end - p))) {
+                    return false;
+                }
+                if (2 == fieldId) {
+                    view.m_payload       = p;
+                    view.m_payloadLength = static_cast<uint32_t>(value);
+                } else if (!decodeTimeStamp(p, p + value, (3 == fieldId) ? view.m_sent : ((4 == fieldId) ? view.m_received : view.m_sampleTime))) {
+                    return false;
+                }
+                p += value;
+            } else if (!skipField(p, end, wireType)) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+/**
+ * This class maps a .rec file into memory and walks the sequence of
+ *
+ *    0x0D 0xA4 LEN0 LEN1 LEN2 Proto-encoded cluon::data::Envelope
+ *
+ * directly in the mapped bytes, yielding EnvelopeViews without any heap
+ * allocation per Envelope. The iteration stops at the end of the file or
+ * at the first truncated or corrupted entry.
+ *
+ * Example:
+ * @code
+ * cluon::MappedRecFile recFile{"myRecording.rec"};
+ * for (const cluon::EnvelopeView &view : recFile) {
+ *     if (opendlv::proxy::GroundSteeringRequest::ID() == view.m_dataType) {
+ *         auto msg = view.message<opendlv::proxy::GroundSteeringRequest>();
+ *     }
+ * }
+ * @endcode
+ */
+class LIBCLUON_API MappedRecFile {
+   public:
+    enum : uint8_t { OD4_HEADER_SIZE = EnvelopeView::OD4_HEADER_SIZE };
+
+   private:
+    MappedRecFile(const MappedRecFile &) = delete;
+    MappedRecFile(MappedRecFile &&)      = delete;
+    MappedRecFile &operator=(MappedRecFile &&) = delete;
+    MappedRecFile &operator=(const MappedRecFile &other) = delete;
+
+   public:
+    class LIBCLUON_API const_iterator {
+       public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = EnvelopeView;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = const EnvelopeView *;
+        using reference         = const EnvelopeView &;
+
+       public:
+        const_iterator(const MappedRecFile *recFile, uint64_t position) noexcept
+            : m_recFile(recFile)
+            , m_position(position)
+            , m_view() {
+            load();
+        }
+
+        reference operator*() const noexcept {
+            return m_view;
+        }
+        pointer operator->() const noexcept {
+            return &m_view;
+        }
+        const_iterator &operator++() noexcept {
+            m_position = m_view.m_filePosition + OD4_HEADER_SIZE + m_view.m_length;
+            load();
+            return *this;
+        }
+        const_iterator operator++(int) noexcept {
+            const_iterator tmp{*this};
+            ++(*this);
+            return tmp;
+        }
+        bool operator==(const const_iterator &other) const noexcept {
+            return (m_recFile == other.m_recFile) && (m_position == other.m_position);
+        }
+        bool operator!=(const const_iterator &other) const noexcept {
+            return !(*this == other);
+        }
+
+       private:
+        void load() noexcept {
+            if (!m_recFile->viewAt(m_position, m_view)) {
+                m_position = m_recFile->size();
+            }
+        }
+
+       private:
+        const MappedRecFile *m_recFile;
+        uint64_t m_position;
+        EnvelopeView m_view;
+    };
+
+   public:
+    /**
+     * Constructor.
+     *
+     * @param file .rec file to map.
+     */
+    explicit MappedRecFile(const std::string &file) noexcept
+        : m_file(file) {}
+
+    /**
+     * @return true if the file could be opened (an empty file is valid).
+     */
+    bool valid() const noexcept {
+        return m_file.valid();
+    }
+
+    /**
+     * @return Size of the file in bytes.
+     */
+    uint64_t size() const noexcept {
+        return m_file.size();
+    }
+
+    /**
+     * @return Pointer to the mapped bytes.
+     */
+    const char *data() const noexcept {
+        return m_file.data();
+    }
+
+    const_iterator begin() const noexcept {
+        return const_iterator(this, 0);
+    }
+    const_iterator end() const noexcept {
+        return const_iterator(this, size());
+    }
+
+    /**
+     * This method decodes the framing and the Envelope fields needed for an
+     * EnvelopeView from the entry starting at the given file position.
+     *
+     * @param position Position of the 0x0D 0xA4 header in the file.
+     * @param view EnvelopeView to fill.
+     * @return true if there is a complete and well-formed entry at position.
+     */
+    bool viewAt(uint64_t position, EnvelopeView &view) const noexcept {
+        const char *DATA{m_file.data()};
+        const uint64_t SIZE{m_file.size()};
+        if ((nullptr == DATA) || (position >= SIZE)) {
+            return false;
+        }
+        const bool retVal{EnvelopeView::decode(DATA + position, static_cast<std::size_t>(SIZE - position), view)};
+        view.m_filePosition = position;
+        return retVal;
+    }
+
+   private:
+    MappedFile m_file;
+};
+
+} // namespace cluon
+
+#endif
+/*
+ * Copyright (C) 2017-2018  Christian Berger
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CLUON_RECFILEINDEX_HPP
+#define CLUON_RECFILEINDEX_HPP
+
+//#include "cluon/cluon.hpp"
+//#include "cluon/RecFileView.hpp"
+
+// clang-format off
+#ifndef WIN32
+    #include <sys/stat.h>
+    #include <unistd.h>
+#else
+    #include <process.h>
+    #include <sys/types.h>
+    #include <sys/stat.h>
+#endif
+// clang-format on
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace cluon {
+
+/**
+ * This class provides access to the sidecar index file (<file>.rec.idx) of a
+ * .rec file. The index lists the sample time stamp, file position, dataType,
+ * and senderStamp of all Envelopes sorted by sample time stamp (and by file
+ * position for equal time stamps) so that a .rec file does not need to be
+ * scanned again when it is opened the next time.
+ *
+ * The index is only used if the .rec file has still the size, modification
+ * time, and checksum over its first and last bytes that were recorded when the
+ * index was written; otherwise, it is considered stale.
+ *
+ * Layout (little endian): 64 bytes header
+ *   "CLUONIDX", uint32 version, uint32 entry size, uint64 .rec file size,
+ *   int64 mtime seconds, int64 mtime nanoseconds, uint64 checksum,
+ *   uint64 number of entries, uint64 reserved
+ * followed by the entries of 24 bytes each:
+ *   int64 sampleTimeStamp (in microseconds), uint64 filePosition, int32 dataType, uint32 senderStamp
+ */
+class LIBCLUON_API RecFileIndex {
+   private:
+    enum : uint32_t {
+        VERSION        = 1,
+        HEADER_SIZE    = 64,
+        ENTRY_SIZE     = 24,
+        CHECKSUM_BLOCK = 64 * 1024,
+        MIN_CHUNK_SIZE = 8 * 1024 * 1024,
+    };
+
+   private:
+    RecFileIndex(const RecFileIndex &) = delete;
+    RecFileIndex(RecFileIndex &&)      = delete;
+    RecFileIndex &operator=(RecFileIndex &&) = delete;
+    RecFileIndex &operator=(const RecFileIndex &other) = delete;
+
+   public:
+    /**
+     * One entry of the index.
+     */
+    struct Entry {
+        int64_t m_sampleTimeStamp{0};
+        uint64_t m_filePosition{0};
+        int32_t m_dataType{0};
+        uint32_t m_senderStamp{0};
+    };
+
+   public:
+    /**
+     * Constructor: Maps the index file belonging to the given .rec file
+     * and validates it against the .rec file.
+     *
+     * @param recFile .rec file for which the index shall be loaded.
+     */
+    explicit RecFileIndex(const std::string &recFile) noexcept
+        : m_indexFile(indexFileFor(recFile))
+        , m_numberOfEntries(0)
+        , m_valid(false) {
+        Stamp stamp;
+        if (m_indexFile.valid() && (HEADER_SIZE <= m_indexFile.size()) && stampOf(recFile, stamp)) {
+            const char *header = m_indexFile.data();
+            const uint64_t NUMBER_OF_ENTRIES{readUInt64(header + 48)};
+            m_valid = (0 == std::memcmp(header, MAGIC(), 8)) && (VERSION == readUInt32(header + 8))
+                      && (ENTRY_SIZE == readUInt32(header + 12)) && (stamp.m_size == readUInt64(header + 16))
+                      && (stamp.m_seconds == static_cast<int64_t>(readUInt64(header + 24)))
+                      && (stamp.m_nanoseconds == static_cast<int64_t>(readUInt64(header + 32)))
+                      && (stamp.m_checksum == readUInt64(header + 40))
+                      && (NUMBER_OF_ENTRIES == (m_indexFile.size() - HEADER_SIZE) / ENTRY_SIZE)
+                      && (0 == (m_indexFile.size() - HEADER_SIZE) % ENTRY_SIZE);
+            m_numberOfEntries = (m_valid ? NUMBER_OF_ENTRIES : 0);
+        }
+    }
+
+    /**
+     * @return Name of the index file for the given .rec file.
+     */
+    static std::string indexFileFor(const std::string &recFile) noexcept {
+        return recFile + ".idx";
+    }
+
+    /**
+     * @return true if the index file exists and matches the .rec file.
+     */
+    bool valid() const noexcept {
+        return m_valid;
+    }
+
+    /**
+     * @return Number of entries in the index.
+     */
+    uint64_t size() const noexcept {
+        return m_numberOfEntries;
+    }
+
+    /**
+     * @param i Entry to return (must be less than size()).
+     * @return i-th entry.
+     */
+    Entry at(uint64_t i) const noexcept {
+        const char *p = m_indexFile.data() + HEADER_SIZE + i * ENTRY_SIZE;
+        Entry entry;
+        entry.m_sampleTimeStamp = static_cast<int64_t>(readUInt64(p));
+        entry.m_filePosition    = readUInt64(p + 8);
+        entry.m_dataType        = static_cast<int32_t>(readUInt32(p + 16));
+        entry.m_senderStamp     = readUInt32(p + 20);
+        return entry;
+    }
+
+    /**
+     * This method creates the entries of an index by scanning a .rec file.
+     * Large files are split into byte ranges that are scanned in parallel:
+     * Each range but the first one is resynchronized on the next OD4 header
+     * (0x0D 0xA4) whose Envelope and the Envelope following it decode, and
+     * only the header fields needed for the index are decoded. When merging
+     * the ranges in file order, a range is only taken from the position where
+     * the previous range's chain of Envelopes ends; a range that had locked on
+     * a false header inside a payload is scanned again from there. Thus, the
+     * result is identical to a sequential scan that stops at the first broken
+     * Envelope.
+     *
+     * @param recFile .rec file to scan.
+     * @param threads Maximum number of threads to use (0 for all cores).
+     * @param bytesRead Number of bytes covered by the returned entries.
+     * @return Entries sorted by sample time stamp and file position.
+     */
+    static std::vector<Entry> scan(const MappedRecFile &recFile, uint32_t threads, uint64_t &bytesRead) noexcept {
+        if (0 == threads) {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        const uint64_t SIZE{recFile.size()};
+        const uint64_t NUMBER_OF_CHUNKS{std::max<uint64_t>(1, std::min<uint64_t>(threads, SIZE / MIN_CHUNK_SIZE))};
+
+        std::vector<Chunk> chunks(static_cast<std::size_t>(NUMBER_OF_CHUNKS));
+        for (uint64_t i{0}; i < NUMBER_OF_CHUNKS; i++) {
+            chunks[i].m_begin = SIZE / NUMBER_OF_CHUNKS * i;
+            chunks[i].m_end   = ((i + 1) == NUMBER_OF_CHUNKS) ? SIZE : SIZE / NUMBER_OF_CHUNKS * (i + 1);
+        }
+        auto scanChunk = [&recFile, &chunks](std::size_t i) {
+            Chunk &chunk = chunks[i];
+            walk(recFile, (0 == i) ? 0 : resync(recFile, chunk.m_begin, chunk.m_end), chunk);
+        };
+        {
+            std::vector<std::thread> scanners;
+            for (std::size_t i{1}; i < chunks.size(); i++) {
+                scanners.emplace_back(scanChunk, i);
+            }
+            scanChunk(0);
+            for (auto &t : scanners) {
+                t.join();
+            }
+        }
+
+        // Stitch the chunks together in file order.
+        std::vector<Entry> entries;
+        uint64_t next{0};
+        for (Chunk &chunk : chunks) {
+            auto it = std::lower_bound(chunk.m_entries.begin(), chunk.m_entries.end(), next, [](const Entry &e, uint64_t position) {
+                return e.m_filePosition < position;
+            });
+            if ((chunk.m_entries.end() == it) || (it->m_filePosition != next)) {
+                // The chunk was not synchronized with the previous one.
+                walk(recFile, next, chunk);
+                it = chunk.m_entries.begin();
+            }
+            entries.insert(entries.end(), it, chunk.m_entries.end());
+            next = chunk.m_exit;
+            if (chunk.m_broken) {
+                break;
+            }
+        }
+        bytesRead = next;
+
+        std::stable_sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) {
+            return a.m_sampleTimeStamp < b.m_sampleTimeStamp;
+        });
+        return entries;
+    }
+
+    /**
+     * This method writes the index for the given .rec file. The index is written
+     * to a temporary file first that is renamed afterwards so that concurrent
+     * readers never see a partially written index; the temporary file's name
+     * is unique per writer (process ID and a random suffix) so that concurrent
+     * writers do not write into the same temporary file.
+     *
+     * @param recFile .rec file for which the index shall be written.
+     * @param entries Entries of the index sorted by sample time stamp and file position.
+     * @return true if the index file could be written.
+     */
+    static bool write(const std::string &recFile, const std::vector<Entry> &entries) noexcept {
+        Stamp stamp;
+        if (!stampOf(recFile, stamp)) {
+            return false;
+        }
+
+        std::string buffer(HEADER_SIZE + entries.size() * ENTRY_SIZE, '\0');
+        char *p = &buffer[0];
+        std::memcpy(p, MAGIC(), 8);
+        writeUInt32(p + 8, VERSION);
+        writeUInt32(p + 12, ENTRY_SIZE);
+        writeUInt64(p + 16, stamp.m_size);
+        writeUInt64(p + 24, static_cast<uint64_t>(stamp.m_seconds));
+        writeUInt64(p + 32, static_cast<uint64_t>(stamp.m_nanoseconds));
+        writeUInt64(p + 40, stamp.m_checksum);
+        writeUInt64(p + 48, entries.size());
+        p += HEADER_SIZE;
+        for (const Entry &e : entries) {
+            writeUInt64(p, static_cast<uint64_t>(e.m_sampleTimeStamp));
+            writeUInt64(p + 8, e.m_filePosition);
+            writeUInt32(p + 16, static_cast<uint32_t>(e.m_dataType));
+            writeUInt32(p + 20, e.m_senderStamp);
+            p += ENTRY_SIZE;
+        }
+
+        const std::string INDEX_FILE{indexFileFor(recFile)};
+        const std::string TMP_FILE{temporaryFileFor(INDEX_FILE)};
+        bool retVal{false};
+        {
+            std::fstream out(TMP_FILE.c_str(), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+            if (out.good()) {
+                out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                out.flush();
+                retVal = out.good();
+            }
+        }
+        if (retVal) {
+#ifdef WIN32
+            std::remove(INDEX_FILE.c_str());
+#endif
+            retVal = (0 == std::rename(TMP_FILE.c_str(), INDEX_FILE.c_str()));
+        }
+        if (!retVal) {
+            std::remove(TMP_FILE.c_str());
+        }
+        return retVal;
+    }
+
+   private:
+    /**
+     * Byte range of a .rec file and the Envelopes starting in it.
+     */
+    struct Chunk {
+        uint64_t m_begin{0};
+        uint64_t m_end{0};
+        std::vector<Entry> m_entries{};
+        uint64_t m_exit{0};    // Position after the last Envelope starting in this range.
+        bool m_broken{false};  // True if an Envelope in this range could not be decoded.
+    };
+
+    /**
+     * This method follows the chain of Envelopes from position until the end of the chunk.
+     * The result of a previous walk over the same chunk is discarded.
+     */
+    static void walk(const MappedRecFile &recFile, uint64_t position, Chunk &chunk) noexcept {
+        chunk.m_entries.clear();
+        chunk.m_exit   = position;
+        chunk.m_broken = false;
+
+        EnvelopeView view;
+        while (position < chunk.m_end) {
+            if (!recFile.viewAt(position, view)) {
+                chunk.m_broken = true;
+                break;
+            }
+            Entry e;
+            e.m_sampleTimeStamp = view.m_sampleTimeStamp;
+            e.m_filePosition    = view.m_filePosition;
+            e.m_dataType        = view.m_dataType;
+            e.m_senderStamp     = view.m_senderStamp;
+            chunk.m_entries.push_back(e);
+            position += MappedRecFile::OD4_HEADER_SIZE + view.m_length;
+        }
+        chunk.m_exit = position;
+    }
+
+    /**
+     * @return Position of the first plausible Envelope in [begin, end), or end.
+     */
+    static uint64_t resync(const MappedRecFile &recFile, uint64_t begin, uint64_t end) noexcept {
+        const uint8_t *data = reinterpret_cast<const uint8_t *>(recFile.data());
+        EnvelopeView view;
+        for (uint64_t p{begin}; (p + 1) < end; p++) {
+            if ((0x0D == data[p]) && (0xA4 == data[p + 1]) && recFile.viewAt(p, view)) {
+                // Require the following Envelope to decode too (unless the file ends here).
+                const uint64_t NEXT{p + MappedRecFile::OD4_HEADER_SIZE + view.m_length};
+                if ((NEXT == recFile.size()) || recFile.viewAt(NEXT, view)) {
+                    return p;
+                }
+            }
+        }
+        return end;
+    }
+
+    /**
+     * Properties of a .rec file that an index is valid for.
+     */
+    struct Stamp {
+        uint64_t m_size{0};
+        int64_t m_seconds{0};
+        int64_t m_nanoseconds{0};
+        uint64_t m_checksum{0};
+    };
+
+    static const char *MAGIC() noexcept {
+        return "CLUONIDX";
+    }
+
+    /**
+     * @return Name of a temporary file next to file that no other writer uses.
+     */
+    static std::string temporaryFileFor(const std::string &file) noexcept {
+        uint64_t suffix{0};
+        try {
+            std::random_device rd;
+            suffix = (static_cast<uint64_t>(rd()) << 32) | rd();
+        } catch (...) { // LCOV_EXCL_LINE
+            suffix = static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count()); // LCOV_EXCL_LINE
+        } // LCOV_EXCL_LINE
+#ifdef WIN32
+        const int PID{::_getpid()};
+#else
+        const pid_t PID{::getpid()};
+#endif
+        std::stringstream sstr;
+        sstr << file << "." << PID << "." << std::hex << suffix << ".tmp";
+        return sstr.str();
+    }
+
+    /**
+     * This method determines size, modification time, and the checksum
+     * (FNV-1a over the first and last CHECKSUM_BLOCK bytes) of a .rec file.
+     */
+    static bool stampOf(const std::string &recFile, Stamp &stamp) noexcept {
+        struct stat info;
+        if (0 != ::stat(recFile.c_str(), &info)) {
+            return false;
+        }
+        stamp.m_size    = static_cast<uint64_t>(info.st_size);
+        stamp.m_seconds = static_cast<int64_t>(info.st_mtime);
+#if defined(__linux__)
+        stamp.m_nanoseconds = static_cast<int64_t>(info.st_mtim.tv_nsec);
+#elif defined(__APPLE__)
+        stamp.m_nanoseconds = static_cast<int64_t>(info.st_mtimespec.tv_nsec);
+#else
+        stamp.m_nanoseconds = 0;
+#endif
+
+        std::fstream in(recFile.c_str(), std::ios_base::in | std::ios_base::binary);
+        if (!in.good()) {
+            return false;
+        }
+        const uint64_t HEAD{std::min<uint64_t>(stamp.m_size, CHECKSUM_BLOCK)};
+        const uint64_t TAIL{std::min<uint64_t>(stamp.m_size - HEAD, CHECKSUM_BLOCK)};
+        std::string block(static_cast<std::size_t>(HEAD + TAIL), '\0');
+        in.read(&block[0], static_cast<std::streamsize>(HEAD));
+        in.seekg(static_cast<std::streamoff>(stamp.m_size - TAIL), std::ios_base::beg);
+        in.read(&block[static_cast<std::size_t>(HEAD)], static_cast<std::streamsize>(TAIL));
+        if (!in.good()) {
+            return false;
+        }
+
+        uint64_t hash{14695981039346656037ull};
+        for (const char c : block) {
+            hash ^= static_cast<uint8_t>(c);
+            hash *= 1099511628211ull;
+        }
+        stamp.m_checksum = hash;
+        return true;
+    }
+
+    static uint32_t readUInt32(const char *p) noexcept {
+        uint32_t v{0};
+        std::memcpy(&v, p, sizeof(v));
+        return le32toh(v);
+    }
+
+    static uint64_t readUInt64(const char *p) noexcept {
+        uint64_t v{0};
+        std::memcpy(&v, p, sizeof(v));
+        return le64toh(v);
+    }
+
+    static void writeUInt32(char *p, uint32_t v) noexcept {
+        v = htole32(v);
+        std::memcpy(p, &v, sizeof(v));
+    }
+
+    static void writeUInt64(char *p, uint64_t v) noexcept {
+        v = htole64(v);
+        std::memcpy(p, &v, sizeof(v));
+    }
+
+   private:
+    MappedFile m_indexFile;
+    uint64_t m_numberOfEntries;
+    bool m_valid;
+};
+
+} // namespace cluon
+
+#endif
+/*
+ * Copyright (C) 2017-2018  Christian Berger
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CLUON_ENVELOPECONVERTER_HPP
+#define CLUON_ENVELOPECONVERTER_HPP
+
+//#include "cluon/MetaMessage.hpp"
+//#include "cluon/cluon.hpp"
+//#include "cluon/cluonDataStructures.hpp"
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace cluon {
+/**
+This class provides various conversion functions to and from Envelope data structures.
+*/
+class LIBCLUON_API EnvelopeConverter {
+   private:
+    EnvelopeConverter(const EnvelopeConverter &) = delete;
+    EnvelopeConverter(EnvelopeConverter &&)      = delete;
+    EnvelopeConverter &operator=(const EnvelopeConverter &) = delete;
+    EnvelopeConverter &operator=(EnvelopeConverter &&) = delete;
+
+   public:
+    EnvelopeConverter() = default;
+
+    /**
+     * This method sets the message specification to be used for
+     * interpreting a given Proto-encoded Envelope.
+     *
+     * @param ms Message specification following the ODVD format.
+     * @return -1 in case of invalid message specification; otherwise, number
+     *         of successfully parsed messages from given message specification.
+     */
+    int32_t setMessageSpecification(const std::string &ms) noexcept;
+
+    /**
+     * This method transforms the given Proto-encoded Envelope to JSON. The
+     * Proto-encoded envelope might be preceded with a 5-bytes OD4-header (optional).
+     *
+     * @param protoEncodedEnvelope Proto-encoded Envelope.
+     * @return JSON representation from given Proto-encoded Envelope using the
+     *         given message specification.
+     */
+    std::string getJSONFromProtoEncodedEnvelope(const std::string &protoEncodedEnvelope) noexcept;
+
+    /**
+     * This method transforms the given Envelope to JSON.
+     *
+     * @param envelope Envelope.
+     * @return JSON representation from given Envelope using the given message specification.
+     */
+    std::string getJSONFromEnvelope(cluon::data::Envelope &envelope) noexcept;
+
+    /**
+     * This method transforms a given JSON representation into a Proto-encoded Envelope
+     * including the prepended OD4-header.
+     *
+     * @param json representation according to the given message specification.
+     * @param messageIdentifier The given JSON representation shall be interpreted
+     *        as the specified message.
+     * @param senderStamp to be used in the Envelope.
+     * @return Proto-encoded Envelope including OD4-header or empty string.
+     */
+    std::string getProtoEncodedEnvelopeFromJSONWithoutTimeStamps(const std::string &json, int32_t messageIdentifier, uint32_t senderStamp) noexcept;
+
+    /**
+     * This method transforms a given JSON representation into a Proto-encoded Envelope
+     * including the prepended OD4-header and setting cluon::time::now() as sampleTimeStamp.
+     *
+     * @param json representation according to the given message specification.
+     * @param messageIdentifier The given JSON representation shall be interpreted
+     *        as the specified message.
+     * @param senderStamp to be used in the Envelope.
+     * @return Proto-encoded Envelope including OD4-header or empty string.
+     */
+    std::string getProtoEncodedEnvelopeFromJSON(const std::string &json, int32_t messageIdentifier, uint32_t senderStamp) noexcept;
+
+   private:
+// clang-format off
+    std::string getProtoEncodedEnvelopeFromJSON(const std::string &json, int32_t messageIdentifier, uint32_t senderStamp, cluon::data::TimeStamp sampleTimeStamp) noexcept;
+// clang-format on
+
+   private:
+    std::vector<cluon::MetaMessage> m_listOfMetaMessages{};
     std::map<int32_t, cluon::MetaMessage> m_scopeOfMetaMessages{};
 };
 } // namespace cluon
@@ -8860,17 +10116,21 @@ class LIBCLUON_API LCMToGenericMessage {
 //#include "cluon/ToProtoVisitor.hpp"
 //#include "cluon/UDPReceiver.hpp"
 //#include "cluon/UDPSender.hpp"
+//#include "cluon/NotifyingPipeline.hpp"
 //#include "cluon/cluon.hpp"
 //#include "cluon/cluonDataStructures.hpp"
 
+#include <atomic>
 #include <chrono>
 #include <cstdint>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 namespace cluon {
 /**
@@ -8910,6 +10170,16 @@ Next to receive Envelopes, OD4Session can call a user-supplied lambda in a time-
 way. The lambda is executed as long as it does not return false or throws an exception
 that is then caught in the method timeTrigger and the method is exited:
 
+By default, all delegates are called one after another from the thread that
+receives the Envelopes. Passing a number of delegate workers lets Envelopes
+with different dataType/senderStamp run in parallel so that an expensive
+delegate (e.g., decoding an image) does not delay small messages; Envelopes
+with the same dataType/senderStamp are still delivered in order:
+
+\code{.cpp}
+cluon::OD4Session od4{111, nullptr, 2}; // Two delegate workers.
+\endcode
+
 \code{.cpp}
 cluon::OD4Session od4{111};
 
@@ -8936,8 +10206,19 @@ class LIBCLUON_API OD4Session {
      *        if a nullptr is passed, the method dataTrigger can be used to set
      *        message specific delegates. Please note that it is NOT possible
      *        to have both: a delegate for "catch-all" and the data-triggered ones.
+     * @param numberOfDelegateWorkers Threads to run the delegates on (0: the receiving thread).
+     *        Each pair of dataType and senderStamp is assigned to one worker, which
+     *        delivers its Envelopes in order; thus, a delegate can run concurrently
+     *        for different senderStamps (or, for the "catch-all" delegate, dataTypes).
+     *        Each pair has its own queue of up to DELEGATE_QUEUE_CAPACITY Envelopes;
+     *        when it is full, the pair's oldest Envelope is dropped. Thus, a busy
+     *        pair never evicts the Envelopes of a rare one on the same worker, and
+     *        the worker takes turns between the pairs that have Envelopes waiting.
      */
-    OD4Session(uint16_t CID, std::function<void(cluon::data::Envelope &&envelope)> delegate = nullptr) noexcept;
+    OD4Session(uint16_t CID, std::function<void(cluon::data::Envelope &&envelope)> delegate = nullptr, uint32_t numberOfDelegateWorkers = 0) noexcept;
+    ~OD4Session() noexcept;
+
+    static constexpr std::size_t DELEGATE_QUEUE_CAPACITY{128};
 
     /**
      * This method will send a given Envelope to this OpenDaVINCI v4 session.
@@ -8998,8 +10279,25 @@ class LIBCLUON_API OD4Session {
    public:
     bool isRunning() noexcept;
 
+    /**
+     * Queue statistics of one dataType/senderStamp when using delegate workers.
+     */
+    struct DelegateQueueStatistics {
+        int32_t m_dataType{0};
+        uint32_t m_senderStamp{0};
+        uint32_t m_worker{0};    // Index of the worker running the delegate.
+        uint64_t m_queued{0};    // Envelopes waiting for the delegate.
+        uint64_t m_delivered{0}; // Envelopes passed to the delegate.
+        uint64_t m_dropped{0};   // Envelopes dropped because the queue of this dataType/senderStamp was full.
+    };
+
+    /**
+     * @return Statistics per dataType/senderStamp seen so far (empty without delegate workers).
+     */
+    std::vector<DelegateQueueStatistics> delegateQueueStatistics() const noexcept;
+
    private:
-    void callback(std::string &&data, std::string &&from, std::chrono::system_clock::time_point &&timepoint) noexcept;
+    void callback(std::string &&data, std::chrono::system_clock::time_point &&timepoint) noexcept;
     void sendInternal(std::string &&dataToSend) noexcept;
 
    private:
@@ -9010,11 +10308,167 @@ class LIBCLUON_API OD4Session {
 
     std::function<void(cluon::data::Envelope &&envelope)> m_delegate{nullptr};
 
+    using MapOfDataTriggeredDelegates = std::unordered_map<int32_t, std::function<void(cluon::data::Envelope &&envelope)>, UseUInt32ValueAsHashKey>;
+
+    // The map is never modified once published: dataTrigger() copies it under
+    // the mutex, changes the copy, swaps it in, and increments the version.
     std::mutex m_mapOfDataTriggeredDelegatesMutex{};
-    std::unordered_map<int32_t, std::function<void(cluon::data::Envelope &&envelope)>, UseUInt32ValueAsHashKey> m_mapOfDataTriggeredDelegates{};
+    std::shared_ptr<const MapOfDataTriggeredDelegates> m_mapOfDataTriggeredDelegates{};
+    std::atomic<uint64_t> m_mapOfDataTriggeredDelegatesVersion{0};
+
+    // Only used from the UDPReceiver's pipeline thread in callback(): the map
+    // in use, reloaded when the version has changed.
+    std::shared_ptr<const MapOfDataTriggeredDelegates> m_currentMapOfDataTriggeredDelegates{};
+    uint64_t m_currentMapOfDataTriggeredDelegatesVersion{0};
+
+   private:
+    struct DelegateJob {
+        std::shared_ptr<const MapOfDataTriggeredDelegates> m_delegates{}; // Keeps m_delegate alive.
+        const std::function<void(cluon::data::Envelope &&envelope)> *m_delegate{nullptr};
+        cluon::data::Envelope m_envelope{};
+    };
+
+    struct DelegateQueue {
+        int32_t m_dataType{0};
+        uint32_t m_senderStamp{0};
+        uint32_t m_worker{0};
+        std::mutex m_mutex{};
+        std::deque<DelegateJob> m_jobs{};
+        bool m_scheduled{false}; // True while the queue is waiting in its worker's pipeline or being run.
+        std::atomic<uint64_t> m_delivered{0};
+        std::atomic<uint64_t> m_dropped{0};
+    };
+
+    void dispatchToWorker(cluon::data::Envelope &&envelope,
+                          const std::function<void(cluon::data::Envelope &&envelope)> *delegate,
+                          const std::shared_ptr<const MapOfDataTriggeredDelegates> &delegates) noexcept;
+    void runDelegateQueue(DelegateQueue *queue) noexcept;
+
+    // A worker's pipeline holds each of its queues at most once while that queue has Envelopes waiting.
+    std::vector<std::unique_ptr<cluon::NotifyingPipeline<DelegateQueue *>>> m_delegateWorkers{};
+
+    // Entries are only added from the receiving thread, which also reads them
+    // without locking; the mutex orders the additions with delegateQueueStatistics().
+    mutable std::mutex m_delegateQueuesMutex{};
+    std::unordered_map<uint64_t, std::unique_ptr<DelegateQueue>> m_delegateQueues{};
+};
+
+} // namespace cluon
+#endif
+/*
+ * Copyright (C) 2017-2018  Christian Berger
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CLUON_SPSCRINGBUFFER_HPP
+#define CLUON_SPSCRINGBUFFER_HPP
+
+//#include "cluon/cluon.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace cluon {
+
+/**
+ * This class provides a bounded FIFO for exactly one producer thread and one
+ * consumer thread. Both sides only use atomic loads and stores on the read and
+ * write counters; the slots are allocated once by reset() and reused.
+ */
+template <class T>
+class LIBCLUON_API SPSCRingBuffer {
+   private:
+    SPSCRingBuffer(const SPSCRingBuffer &) = delete;
+    SPSCRingBuffer(SPSCRingBuffer &&)      = delete;
+    SPSCRingBuffer &operator=(const SPSCRingBuffer &) = delete;
+    SPSCRingBuffer &operator=(SPSCRingBuffer &&) = delete;
+
+   public:
+    SPSCRingBuffer() = default;
+
+    /**
+     * This method empties the ring buffer and changes its capacity; it must
+     * not be called while a producer or consumer is using the ring buffer.
+     *
+     * @param capacity Maximum number of entries (at least 1).
+     */
+    void reset(std::size_t capacity) noexcept {
+        m_slots.clear();
+        m_slots.resize((0 < capacity) ? capacity : 1);
+        m_read.store(0, std::memory_order_relaxed);
+        m_write.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * @return Maximum number of entries.
+     */
+    std::size_t capacity() const noexcept {
+        return m_slots.size();
+    }
+
+    /**
+     * @return Number of entries (a snapshot when called concurrently).
+     */
+    std::size_t size() const noexcept {
+        const uint64_t WRITE{m_write.load(std::memory_order_acquire)};
+        return static_cast<std::size_t>(WRITE - m_read.load(std::memory_order_acquire));
+    }
+
+    /**
+     * This method is only to be called from the producer.
+     *
+     * @return true if there is no space left.
+     */
+    bool full() const noexcept {
+        return m_write.load(std::memory_order_relaxed) - m_read.load(std::memory_order_acquire) >= m_slots.size();
+    }
+
+    /**
+     * This method is only to be called from the producer.
+     *
+     * @param entry Entry to append.
+     * @return true if the entry was appended, false if the ring buffer is full.
+     */
+    bool push(T &&entry) noexcept {
+        const uint64_t WRITE{m_write.load(std::memory_order_relaxed)};
+        if (WRITE - m_read.load(std::memory_order_acquire) >= m_slots.size()) {
+            return false;
+        }
+        m_slots[static_cast<std::size_t>(WRITE % m_slots.size())] = std::move(entry);
+        m_write.store(WRITE + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * This method is only to be called from the consumer.
+     *
+     * @param entry Oldest entry, moved out of the ring buffer.
+     * @return true if an entry was available.
+     */
+    bool pop(T &entry) noexcept {
+        const uint64_t READ{m_read.load(std::memory_order_relaxed)};
+        if (READ == m_write.load(std::memory_order_acquire)) {
+            return false;
+        }
+        entry = std::move(m_slots[static_cast<std::size_t>(READ % m_slots.size())]);
+        m_read.store(READ + 1, std::memory_order_release);
+        return true;
+    }
+
+   private:
+    std::vector<T> m_slots{};
+    std::atomic<uint64_t> m_read{0};
+    std::atomic<uint64_t> m_write{0};
 };
 
 } // namespace cluon
+
 #endif
 /*
  * Copyright (C) 2017-2018  Christian Berger
@@ -9029,29 +10483,83 @@ class LIBCLUON_API OD4Session {
 
 //#include "cluon/cluon.hpp"
 //#include "cluon/cluonDataStructures.hpp"
+//#include "cluon/RecFileView.hpp"
+//#include "cluon/SPSCRingBuffer.hpp"
 
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
-#include <deque>
-#include <fstream>
 #include <functional>
-#include <map>
-#include <memory>
 #include <mutex>
+#include <set>
 #include <string>
 #include <thread>
 #include <utility>
+#include <vector>
 
 namespace cluon {
 
+/**
+ * This class describes which cluon::data::Envelopes shall be replayed by a
+ * Player: An empty filter accepts all Envelopes; otherwise, an Envelope is
+ * accepted if its dataType is allowed for all senderStamps or if its pair
+ * of dataType and senderStamp is allowed.
+ */
+class LIBCLUON_API EnvelopeFilter {
+   public:
+    EnvelopeFilter() = default;
+
+    /**
+     * This method parses a comma-separated list of dataType or
+     * dataType/senderStamp, like "1055,1086/0".
+     *
+     * @param list List to parse.
+     * @return Pair of bool and filter; if bool is false, the list is malformed.
+     */
+    static std::pair<bool, EnvelopeFilter> fromString(const std::string &list) noexcept;
+
+    /**
+     * This method allows a dataType for all senderStamps.
+     *
+     * @param dataType dataType to allow.
+     * @return Reference to this instance.
+     */
+    EnvelopeFilter &allow(int32_t dataType) noexcept;
+
+    /**
+     * This method allows a dataType for one senderStamp.
+     *
+     * @param dataType dataType to allow.
+     * @param senderStamp senderStamp to allow.
+     * @return Reference to this instance.
+     */
+    EnvelopeFilter &allow(int32_t dataType, uint32_t senderStamp) noexcept;
+
+    /**
+     * @return true if nothing was allowed explicitly, i.e., all Envelopes are accepted.
+     */
+    bool acceptsAll() const noexcept;
+
+    /**
+     * @return true if an Envelope with the given dataType and senderStamp shall be replayed.
+     */
+    bool accepts(int32_t dataType, uint32_t senderStamp) const noexcept;
+
+   private:
+    std::set<int32_t> m_dataTypes{};
+    std::set<std::pair<int32_t, uint32_t>> m_dataTypesAndSenderStamps{};
+};
+
 class LIBCLUON_API IndexEntry {
    public:
     IndexEntry() = default;
-    IndexEntry(const int64_t &sampleTimeStamp, const uint64_t &filePosition) noexcept;
+    IndexEntry(const int64_t &sampleTimeStamp, const uint64_t &filePosition, const int32_t &dataType = 0, const uint32_t &senderStamp = 0) noexcept;
 
    public:
     int64_t m_sampleTimeStamp{0};
     uint64_t m_filePosition{0};
-    bool m_available{0};
+    int32_t m_dataType{0};
+    uint32_t m_senderStamp{0};
 };
 
 class LIBCLUON_API Player {
@@ -9062,6 +10570,7 @@ class LIBCLUON_API Player {
         MAX_DELAY_IN_MICROSECONDS       = 1 * ONE_SECOND_IN_MICROSECONDS,
         LOOK_AHEAD_IN_S                 = 30,
         MIN_ENTRIES_FOR_LOOK_AHEAD      = 5000,
+        ENTRIES_PER_REFILL              = 100,
     };
 
    private:
@@ -9077,8 +10586,9 @@ class LIBCLUON_API Player {
      * @param file File to play.
      * @param autoRewind True if the file should be rewind at EOF.
      * @param threading If set to true, player will load new envelopes from the files in background.
+     * @param filter Envelopes to replay; all other Envelopes are left out of the index and never read.
      */
-    Player(const std::string &file, const bool &autoRewind, const bool &threading) noexcept;
+    Player(const std::string &file, const bool &autoRewind, const bool &threading, const EnvelopeFilter &filter = EnvelopeFilter()) noexcept;
     ~Player();
 
     /**
@@ -9105,7 +10615,15 @@ class LIBCLUON_API Player {
     void seekTo(float ratio) noexcept;
 
     /**
-     * @return total amount of cluon::data::Envelopes in the .rec file.
+     * This method continues the replay with the first cluon::data::Envelope
+     * whose sample time stamp is not before the given one.
+     *
+     * @param sampleTimeStamp Sample time stamp to seek to.
+     */
+    void seekToSampleTimeStamp(const cluon::data::TimeStamp &sampleTimeStamp) noexcept;
+
+    /**
+     * @return total amount of cluon::data::Envelopes in the .rec file that pass the filter.
      */
     uint32_t totalNumberOfEnvelopesInRecFile() const noexcept;
 
@@ -9120,6 +10638,24 @@ class LIBCLUON_API Player {
      */
     void initializeIndex() noexcept;
 
+    /**
+     * This method loads the global index from the sidecar index file.
+     *
+     * @return true if a valid index file was found and loaded.
+     */
+    bool loadIndexFromIndexFile() noexcept;
+
+    /**
+     * This method creates the global index by scanning the rec file
+     * and stores it in the sidecar index file for the next time.
+     */
+    void createIndexFromRecFile() noexcept;
+
+    /**
+     * This method adds an entry to the global index if it passes the filter.
+     */
+    inline void addToIndex(const RecFileIndex::Entry &e) noexcept;
+
     /**
      * This method computes the initially required amount of
      * cluon::data::Envelope in the cache and fill the cache accordingly.
@@ -9127,14 +10663,19 @@ class LIBCLUON_API Player {
     void computeInitialCacheLevelAndFillCache() noexcept;
 
     /**
-     * This method clears all caches.
+     * This method clears the cache and lets the replay (and the
+     * filling of the cache) continue at the given entry of the index.
+     *
+     * @param entry Entry in the global index.
      */
-    void resetCaches() noexcept;
+    void resetCacheTo(std::size_t entry) noexcept;
 
     /**
-     * This method resets the iterators.
+     * This method continues the replay at the given entry of the index.
+     *
+     * @param entry Entry in the global index.
      */
-    inline void resetIterators() noexcept;
+    void seekToEntry(std::size_t entry) noexcept;
 
     /**
      * This method fills the cache by trying to read up
@@ -9146,8 +10687,8 @@ class LIBCLUON_API Player {
     uint32_t fillEnvelopeCache(const uint32_t &maxNumberOfEntriesToReadFromFile) noexcept;
 
     /**
-     * This method checks the availability of the next cluon::data::Envelope
-     * to be replayed from the cache.
+     * This method waits for the next cluon::data::Envelope
+     * to be replayed to become available in the cache.
      */
     inline void checkAvailabilityOfNextEnvelopeToBeReplayed() noexcept;
 
@@ -9156,34 +10697,33 @@ class LIBCLUON_API Player {
 
     std::string m_file;
 
-    // Handle to .rec file.
-    std::fstream m_recFile;
+    // Memory-mapped .rec file.
+    MappedRecFile m_recFile;
     bool m_recFileValid;
 
+    EnvelopeFilter m_filter;
+
    private: // Player states.
     bool m_autoRewind;
 
    private: // Index and cache management.
-    // Global index: Mapping SampleTimeStamp --> cache entry (holding the actual content from .rec file).
-    mutable std::mutex m_indexMutex;
-    std::multimap<int64_t, IndexEntry> m_index;
-
-    // Pointers to the current envelope to be replayed and the
-    // envelope that has be replayed from the global index.
-    std::multimap<int64_t, IndexEntry>::iterator m_previousPreviousEnvelopeAlreadyReplayed;
-    std::multimap<int64_t, IndexEntry>::iterator m_previousEnvelopeAlreadyReplayed;
-    std::multimap<int64_t, IndexEntry>::iterator m_currentEnvelopeToReplay;
+    // Global index sorted by sample time stamp (and file position for equal
+    // sample time stamps); it is not modified after the constructor.
+    std::vector<IndexEntry> m_index;
 
-    // Information about the index.
-    std::multimap<int64_t, IndexEntry>::iterator m_nextEntryToReadFromRecFile;
+    // Positions in the global index of the envelope to be replayed next,
+    // the envelope that has been replayed last, and the envelope to be
+    // read next from the rec file into the cache.
+    std::size_t m_previousEnvelopeAlreadyReplayed;
+    std::size_t m_currentEnvelopeToReplay;
+    std::size_t m_nextEntryToReadFromRecFile;
 
     uint32_t m_desiredInitialLevel;
 
     // Fields to compute replay throughput for cache management.
-    cluon::data::TimeStamp m_firstTimePointReturningAEnvelope;
-    uint64_t m_numberOfReturnedEnvelopesInTotal;
+    std::atomic<uint64_t> m_numberOfReturnedEnvelopesInTotal;
 
-    uint32_t m_delay;
+    std::atomic<uint32_t> m_delay;
 
    private:
     /**
@@ -9199,22 +10739,15 @@ class LIBCLUON_API Player {
      */
     void manageCache() noexcept;
 
-    /**
-     * This method checks whether the cache needs to be refilled.
-     *
-     * @param numberOfEntries Number of entries in cache.
-     * @param refillMultiplicator Multiplicator to modify the amount of envelopes to be refilled.
-     * @return Modified refillMultiplicator recommedned to be used next time
-     */
-    float checkRefillingCache(const uint32_t &numberOfEntries, float refillMultiplicator) noexcept;
-
    private:
-    mutable std::mutex m_envelopeCacheFillingThreadIsRunningMutex;
-    bool m_envelopeCacheFillingThreadIsRunning;
+    std::atomic<bool> m_envelopeCacheFillingThreadIsRunning;
     std::thread m_envelopeCacheFillingThread;
 
-    // Mapping of pos_type (within .rec file) --> cluon::data::Envelope (read from .rec file).
-    std::map<uint64_t, cluon::data::Envelope> m_envelopeCache;
+    // cluon::data::Envelopes read from the .rec file that are to be replayed next,
+    // in the order of the global index starting at m_currentEnvelopeToReplay. It
+    // is filled by the envelopeCacheFilling thread (or by the replaying thread if
+    // the Player is non-threaded) and emptied by the replaying thread.
+    SPSCRingBuffer<cluon::data::Envelope> m_envelopeCache;
 
    public:
     void setPlayerListener(std::function<void(cluon::data::PlayerStatus playerStatus)> playerListener) noexcept;
@@ -9253,6 +10786,7 @@ class LIBCLUON_API Player {
 #include <cstddef>
 #include <cstdint>
 #include <atomic>
+#include <chrono>
 #include <string>
 #include <utility>
 
@@ -9315,102 +10849,602 @@ class LIBCLUON_API SharedMemory {
     bool setTimeStamp(const cluon::data::TimeStamp &ts) noexcept;
 
     /**
-     * This method returns the sample time stamp.
+     * This method returns the sample time stamp.
+     *
+     * This method is only allowed when the shared memory is locked.
+     *
+     * @return (true, sample time stamp) or (false, 0) in case if the shared memory was not locked.
+     */
+    std::pair<bool, cluon::data::TimeStamp> getTimeStamp() noexcept;
+
+   public:
+    /**
+     * Writers built with this version append a small frame synchronisation
+     * block behind the user data: the creating writer increments its frame
+     * sequence number in unlock() (still holding the lock; other writers in
+     * notifyAll()), and a consumer can ask the creating writer to wait in
+     * lock() until it has marked the previous frame as done (handshake mode).
+     * Areas created by older writers do not have this block.
+     *
+     * @return true if the attached shared memory area has frame sequence numbers.
+     */
+    bool hasFrameSequenceNumbers() const noexcept;
+
+    /**
+     * @return Number of frames written so far or 0 if not available.
+     */
+    uint64_t frameSequenceNumber() const noexcept;
+
+    /**
+     * This method returns how many frames a consumer has skipped: the frames
+     * written after the one seen at the previous call (or at attaching) and
+     * before the current one. Call it once per frame read while the shared
+     * memory is locked; as the creating writer counts a frame before
+     * unlocking, the count refers exactly to the frame being read.
+     *
+     * @return Number of frames skipped since the last call or 0 if the shared memory area has no frame sequence numbers.
+     */
+    uint64_t skippedFrames() noexcept;
+
+    /**
+     * This method enables or disables the handshake mode of a consumer: while
+     * enabled, the creating writer waits in lock() until the last notified
+     * frame has been marked as done by frameDone(). If that takes more than
+     * one second, the writer suspends the handshake so that a stalled consumer
+     * cannot block it (see handshakeSuspended()) and resumes it as soon as the
+     * consumer marks a newer frame as done. Only one consumer per shared
+     * memory area may use the handshake mode.
+     *
+     * @param enabled True to enable the handshake mode.
+     * @return true if the handshake mode could be changed; false if the shared memory area has no frame sequence numbers.
+     */
+    bool setHandshake(bool enabled) noexcept;
+
+    /**
+     * This method marks all frames up to the given one as processed so that
+     * the writer can continue in handshake mode.
+     *
+     * @param frameSequenceNumber Frame sequence number of the processed frame.
+     */
+    void frameDone(uint64_t frameSequenceNumber) noexcept;
+
+    /**
+     * @return true if the consumer enabled the handshake mode but the writer
+     * currently does not wait for it as it did not finish a frame in time.
+     */
+    bool handshakeSuspended() const noexcept;
+
+    /**
+     * This method waits until a frame newer than the given one was notified.
+     * Other than wait(), it cannot miss a notification as it checks the frame
+     * sequence number instead of waiting on the shared condition.
+     *
+     * @param frameSequenceNumber Frame sequence number of the last frame taken.
+     * @param timeout Maximum time to wait.
+     * @return true if a newer frame is available; false on timeout or if the shared memory area has no frame sequence numbers.
+     */
+    bool waitForFrame(uint64_t frameSequenceNumber, const std::chrono::milliseconds &timeout) noexcept;
+
+   public:
+    /**
+     * @return True if the shared memory area is existing and usable.
+     */
+    bool valid() noexcept;
+
+    /**
+     * @return Pointer to the raw shared memory or nullptr in case of invalid shared memory.
+     */
+    char *data() noexcept;
+
+    /**
+     * @return The size of the shared memory area.
+     */
+    uint32_t size() const noexcept;
+
+    /**
+     * @return Name the shared memory area.
+     */
+    const std::string name() const noexcept;
+
+#ifdef WIN32
+   private:
+    void initWIN32() noexcept;
+    void deinitWIN32() noexcept;
+    void lockWIN32() noexcept;
+    void unlockWIN32() noexcept;
+    void waitWIN32() noexcept;
+    void notifyAllWIN32() noexcept;
+#else
+   private:
+    void initPOSIX() noexcept;
+    void deinitPOSIX() noexcept;
+    void lockPOSIX() noexcept;
+    void unlockPOSIX() noexcept;
+    void waitPOSIX() noexcept;
+    void notifyAllPOSIX() noexcept;
+    bool validPOSIX() noexcept;
+
+    void initSysV() noexcept;
+    void deinitSysV() noexcept;
+    void lockSysV() noexcept;
+    void unlockSysV() noexcept;
+    void waitSysV() noexcept;
+    void notifyAllSysV() noexcept;
+    bool validSysV() noexcept;
+
+    static uint32_t frameSyncOffset(uint32_t size) noexcept;
+    void createFrameSync(char *at) noexcept;
+    bool attachFrameSync(char *at) noexcept;
+    void waitForFrameDone() noexcept;
+
+    // Values of SharedMemoryFrameSync::__handshake.
+    enum : uint32_t {
+        HANDSHAKE_OFF       = 0,
+        HANDSHAKE_ON        = 1,
+        HANDSHAKE_SUSPENDED = 2, // Set by the writer after a timeout; the consumer's frameDone() resumes it.
+    };
+#endif
+
+   private:
+    std::string m_name{""};
+    std::string m_nameForTimeStamping{""};
+    uint32_t m_size{0};
+    char *m_sharedMemory{nullptr};
+    char *m_userAccessibleSharedMemory{nullptr};
+    bool m_hasOnlyAttachedToSharedMemory{false};
+
+    std::atomic<bool> m_broken{false};
+    std::atomic<bool> m_isLocked{false};
+
+#ifdef WIN32
+    HANDLE __conditionEvent{nullptr};
+    HANDLE __mutex{nullptr};
+    HANDLE __sharedMemory{nullptr};
+#else
+    int32_t m_fdForTimeStamping{-1};
+
+    bool m_usePOSIX{true};
+
+    // Frame synchronisation block behind the user data (at frameSyncOffset(__size)).
+    struct SharedMemoryFrameSync {
+        uint64_t __magic;
+        uint32_t __size;
+        std::atomic<uint32_t> __handshake;
+        std::atomic<uint64_t> __frameSequenceNumber;
+        std::atomic<uint64_t> __frameDone;
+    };
+    static constexpr uint64_t FRAME_SYNC_MAGIC{0x3153464e4f554c43ull}; // "CLUONFS1"
+    SharedMemoryFrameSync *m_frameSync{nullptr};
+    bool m_handshake{false};
+    uint64_t m_lastFrameSequenceNumber{0};
+    bool m_frameCountedInUnlock{false};
+    uint64_t m_handshakeSuspendedAt{0};
+
+    // Member fields for POSIX-based shared memory.
+#if !defined(__NetBSD__) && !defined(__OpenBSD__)
+    int32_t m_fd{-1};
+    std::size_t m_mappedSize{0};
+    struct SharedMemoryHeader {
+        uint32_t __size;
+        pthread_mutex_t __mutex;
+        pthread_cond_t __condition;
+    };
+    SharedMemoryHeader *m_sharedMemoryHeader{nullptr};
+#endif
+
+    // Member fields for SysV-based shared memory.
+    key_t m_shmKeySysV{0};
+    key_t m_mutexKeySysV{0};
+    key_t m_conditionKeySysV{0};
+
+    int m_sharedMemoryIDSysV{-1};
+    int m_mutexIDSysV{-1};
+    int m_conditionIDSysV{-1};
+#endif
+};
+} // namespace cluon
+
+#endif
+/*
+ * Copyright (C) 2017-2018  Christian Berger
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef CLUON_SHAREDMEMORYRING_HPP
+#define CLUON_SHAREDMEMORYRING_HPP
+
+//#include "cluon/cluon.hpp"
+//#include "cluon/cluonDataStructures.hpp"
+//#include "cluon/Time.hpp"
+
+// clang-format off
+#ifndef WIN32
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+#ifdef __linux__
+    #include <linux/futex.h>
+    #include <sys/syscall.h>
+    #include <time.h>
+#endif
+// clang-format on
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+
+namespace cluon {
+/**
+ * This class provides a shared memory area with several slots for frames
+ * (e.g., decoded images) that one writer fills in turn while readers always
+ * take the newest complete frame. Other than SharedMemory, there is no
+ * shared lock: the writer never waits for readers, and each slot has its own
+ * sequence number so that a reader can tell whether the frame it copied was
+ * overwritten in the meantime (which can only happen if copying took longer
+ * than slots() - 1 frames).
+ *
+ * Writer:
+ * @code
+ * cluon::SharedMemoryRing ring{"img", 640 * 480 * 4, 4};
+ * char *frame = ring.beginWrite();
+ * // ... fill frame ...
+ * ring.endWrite(cluon::time::now());
+ * @endcode
+ *
+ * Reader:
+ * @code
+ * cluon::SharedMemoryRing ring{"img"};
+ * uint64_t last{0};
+ * while (ring.waitForFrame(last, std::chrono::milliseconds(100))) {
+ *     cluon::data::TimeStamp ts;
+ *     const char *frame{nullptr};
+ *     do {
+ *         frame = ring.beginRead(last, ts);
+ *         // ... copy from frame ...
+ *     } while (!ring.endRead());
+ * }
+ * @endcode
+ *
+ * The area is a POSIX shared memory object named like the SharedMemory with
+ * the same name plus ".ring", so that both can exist side by side. Waiting
+ * readers are woken with a futex on Linux; elsewhere, they poll.
+ */
+class LIBCLUON_API SharedMemoryRing {
+   private:
+    SharedMemoryRing(const SharedMemoryRing &) = delete;
+    SharedMemoryRing(SharedMemoryRing &&)      = delete;
+    SharedMemoryRing &operator=(const SharedMemoryRing &) = delete;
+    SharedMemoryRing &operator=(SharedMemoryRing &&) = delete;
+
+   public:
+    /**
+     * Constructor.
+     *
+     * @param name Name of the shared memory area.
+     * @param size Size of one frame; if size is 0, the class tries to attach to an existing area.
+     * @param slots Number of frames in the ring (at least 2).
+     */
+    SharedMemoryRing(const std::string &name, uint32_t size = 0, uint32_t slots = 4) noexcept
+        : m_name((name.empty() || ('/' != name[0])) ? "/" + name + ".ring" : name + ".ring") {
+#ifndef WIN32
+        const bool CREATE{0 < size};
+        int flags = O_RDWR;
+        if (CREATE) {
+            flags |= O_CREAT | O_EXCL;
+        }
+        m_fd = ::shm_open(m_name.c_str(), flags, S_IRUSR | S_IWUSR);
+        if ((-1 == m_fd) && CREATE && (EEXIST == errno)) {
+            // Remove an orphaned area and try again.
+            ::shm_unlink(m_name.c_str());
+            m_fd = ::shm_open(m_name.c_str(), flags, S_IRUSR | S_IWUSR);
+        }
+        if (-1 == m_fd) {
+            if (CREATE) {
+                std::cerr << "[cluon::SharedMemoryRing] Failed to create '" << m_name << "': " << ::strerror(errno) << " (" << errno << ")" << std::endl;
+            }
+            return;
+        }
+
+        if (CREATE) {
+            m_slots      = (slots < 2) ? 2 : slots;
+            m_size       = size;
+            m_mappedSize = HEADER_SIZE + static_cast<std::size_t>(m_slots) * slotSize(m_size);
+            m_isCreator  = (0 == ::ftruncate(m_fd, static_cast<off_t>(m_mappedSize)));
+            if (!m_isCreator) {
+                std::cerr << "[cluon::SharedMemoryRing] Failed to truncate '" << m_name << "': " << ::strerror(errno) << " (" << errno << ")" << std::endl;
+                ::shm_unlink(m_name.c_str());
+                return;
+            }
+        } else {
+            // Take the layout from the header of the existing area.
+            struct stat info;
+            if ((0 != ::fstat(m_fd, &info)) || (static_cast<std::size_t>(info.st_size) < HEADER_SIZE)) {
+                return;
+            }
+            void *header = ::mmap(nullptr, HEADER_SIZE, PROT_READ, MAP_SHARED, m_fd, 0);
+            if (MAP_FAILED == header) {
+                return;
+            }
+            const SharedMemoryRingHeader *h = static_cast<const SharedMemoryRingHeader *>(header);
+            if (MAGIC == h->__magic) {
+                m_slots = h->__slots;
+                m_size  = h->__size;
+            }
+            ::munmap(header, HEADER_SIZE);
+            m_mappedSize = HEADER_SIZE + static_cast<std::size_t>(m_slots) * slotSize(m_size);
+            if ((0 == m_slots) || (static_cast<std::size_t>(info.st_size) != m_mappedSize)) {
+                return;
+            }
+        }
+
+        void *mapping = ::mmap(nullptr, m_mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+        if (MAP_FAILED == mapping) {
+            std::cerr << "[cluon::SharedMemoryRing] Failed to map '" << m_name << "': " << ::strerror(errno) << " (" << errno << ")" << std::endl;
+            return;
+        }
+        m_sharedMemory = static_cast<char *>(mapping);
+        m_header       = reinterpret_cast<SharedMemoryRingHeader *>(m_sharedMemory);
+
+        if (CREATE) {
+            // The fresh area is zeroed, i.e., no slot holds a frame yet; the magic number is set last.
+            m_header->__slots = m_slots;
+            m_header->__size  = m_size;
+            m_header->__frameSequenceNumber.store(0);
+            m_header->__notification.store(0);
+            m_header->__waiters.store(0);
+            m_header->__magic = MAGIC;
+        } else {
+            // Frames written before attaching are not skipped.
+            m_lastRead = m_header->__frameSequenceNumber.load();
+        }
+#else
+        (void)size;
+        (void)slots;
+#endif
+    }
+
+    ~SharedMemoryRing() noexcept {
+#ifndef WIN32
+        if (nullptr != m_sharedMemory) {
+            ::munmap(m_sharedMemory, m_mappedSize);
+        }
+        if (-1 != m_fd) {
+            ::close(m_fd);
+            if (m_isCreator) {
+                ::shm_unlink(m_name.c_str());
+            }
+        }
+#endif
+    }
+
+    /**
+     * @return true if the shared memory area is existing and usable.
+     */
+    bool valid() const noexcept {
+        return (nullptr != m_header);
+    }
+
+    /**
+     * @return Name of the shared memory area.
+     */
+    const std::string name() const noexcept {
+        return m_name;
+    }
+
+    /**
+     * @return Size of one frame.
+     */
+    uint32_t size() const noexcept {
+        return m_size;
+    }
+
+    /**
+     * @return Number of frames in the ring.
+     */
+    uint32_t slots() const noexcept {
+        return m_slots;
+    }
+
+    /**
+     * @return Sequence number of the newest complete frame (starting at 1) or 0 if none was written yet.
+     */
+    uint64_t frameSequenceNumber() const noexcept {
+        return (nullptr != m_header) ? m_header->__frameSequenceNumber.load() : 0;
+    }
+
+    /**
+     * This method starts writing the next frame; it never waits. Only one
+     * writer per shared memory area is allowed.
+     *
+     * @return Pointer to the size() bytes of the next slot or nullptr in case of invalid shared memory.
+     */
+    char *beginWrite() noexcept {
+        if (nullptr == m_header) {
+            return nullptr;
+        }
+        m_writing                  = m_header->__frameSequenceNumber.load() + 1;
+        SharedMemoryRingSlot *slot = slotFor(m_writing);
+        // Readers of a previous frame in this slot notice the change of the sequence number.
+        slot->__sequenceNumber.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        return reinterpret_cast<char *>(slot) + SLOT_HEADER_SIZE;
+    }
+
+    /**
+     * This method publishes the frame started with beginWrite() and wakes
+     * waiting readers.
      *
-     * This method is only allowed when the shared memory is locked.
-     *
-     * @return (true, sample time stamp) or (false, 0) in case if the shared memory was not locked.
+     * @param sampleTimeStamp Sample time stamp of the frame.
      */
-    std::pair<bool, cluon::data::TimeStamp> getTimeStamp() noexcept;
+    void endWrite(const cluon::data::TimeStamp &sampleTimeStamp) noexcept {
+        if ((nullptr == m_header) || (0 == m_writing)) {
+            return;
+        }
+        SharedMemoryRingSlot *slot = slotFor(m_writing);
+        slot->__sampleTimeStamp.store(cluon::time::toMicroseconds(sampleTimeStamp), std::memory_order_relaxed);
+        slot->__sequenceNumber.store(m_writing, std::memory_order_release);
+        m_header->__frameSequenceNumber.store(m_writing);
+        m_header->__notification.fetch_add(1);
+        m_writing = 0;
+#ifdef __linux__
+        if (0 < m_header->__waiters.load()) {
+            ::syscall(SYS_futex, reinterpret_cast<uint32_t *>(&m_header->__notification), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+        }
+#endif
+    }
 
-   public:
     /**
-     * @return True if the shared memory area is existing and usable.
+     * This method waits until a frame newer than the given one was written.
+     *
+     * @param frameSequenceNumber Sequence number of the last frame taken.
+     * @param timeout Maximum time to wait.
+     * @return true if a newer frame is available; false on timeout or in case of invalid shared memory.
      */
-    bool valid() noexcept;
+    bool waitForFrame(uint64_t frameSequenceNumber, const std::chrono::milliseconds &timeout) noexcept {
+        if (nullptr == m_header) {
+            return false;
+        }
+        const auto DEADLINE = std::chrono::steady_clock::now() + timeout;
+        while (true) {
+            // Read the notification counter first so that a frame written in between makes the futex return immediately.
+            const uint32_t NOTIFICATION{m_header->__notification.load()};
+            if (m_header->__frameSequenceNumber.load() > frameSequenceNumber) {
+                return true;
+            }
+            const auto NOW = std::chrono::steady_clock::now();
+            if (NOW >= DEADLINE) {
+                return false;
+            }
+#ifdef __linux__
+            const int64_t REMAINING{std::chrono::duration_cast<std::chrono::nanoseconds>(DEADLINE - NOW).count()};
+            struct timespec remaining;
+            remaining.tv_sec  = static_cast<time_t>(REMAINING / 1000000000L);
+            remaining.tv_nsec = static_cast<long>(REMAINING % 1000000000L);
+            m_header->__waiters.fetch_add(1);
+            ::syscall(SYS_futex, reinterpret_cast<uint32_t *>(&m_header->__notification), FUTEX_WAIT, NOTIFICATION, &remaining, nullptr, 0);
+            m_header->__waiters.fetch_sub(1);
+#else
+            (void)NOTIFICATION;
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+#endif
+        }
+    }
 
     /**
-     * @return Pointer to the raw shared memory or nullptr in case of invalid shared memory.
+     * This method starts reading the newest complete frame; the data must be
+     * copied before calling endRead().
+     *
+     * @param frameSequenceNumber Sequence number of the frame.
+     * @param sampleTimeStamp Sample time stamp of the frame.
+     * @return Pointer to the size() bytes of the frame or nullptr if no frame was written yet.
      */
-    char *data() noexcept;
+    const char *beginRead(uint64_t &frameSequenceNumber, cluon::data::TimeStamp &sampleTimeStamp) noexcept {
+        m_reading = 0;
+        if (nullptr == m_header) {
+            return nullptr;
+        }
+        // The slot of the newest frame can only be taken by the writer if it has written slots() - 1 frames meanwhile; try again with the then newest one.
+        uint64_t newest{m_header->__frameSequenceNumber.load()};
+        while ((0 < newest) && (slotFor(newest)->__sequenceNumber.load(std::memory_order_acquire) != newest)) {
+            newest = m_header->__frameSequenceNumber.load();
+        }
+        if (0 == newest) {
+            return nullptr;
+        }
+        const SharedMemoryRingSlot *slot = slotFor(newest);
+        m_reading                        = newest;
+        frameSequenceNumber              = newest;
+        sampleTimeStamp                  = cluon::time::fromMicroseconds(slot->__sampleTimeStamp.load(std::memory_order_relaxed));
+        return reinterpret_cast<const char *>(slot) + SLOT_HEADER_SIZE;
+    }
 
     /**
-     * @return The size of the shared memory area.
+     * This method finishes reading the frame from beginRead().
+     *
+     * @return true if the frame was not overwritten while being read; otherwise, the copied data must be discarded and the frame read again.
      */
-    uint32_t size() const noexcept;
+    bool endRead() noexcept {
+        if (0 == m_reading) {
+            return false;
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const bool UNCHANGED{slotFor(m_reading)->__sequenceNumber.load(std::memory_order_relaxed) == m_reading};
+        if (UNCHANGED) {
+            if (m_reading > m_lastRead + 1) {
+                m_skipped += m_reading - m_lastRead - 1;
+            }
+            if (m_reading > m_lastRead) {
+                m_lastRead = m_reading;
+            }
+        }
+        m_reading = 0;
+        return UNCHANGED;
+    }
 
     /**
-     * @return Name the shared memory area.
+     * @return Number of frames that were written but not read since the last call.
      */
-    const std::string name() const noexcept;
-
-#ifdef WIN32
-   private:
-    void initWIN32() noexcept;
-    void deinitWIN32() noexcept;
-    void lockWIN32() noexcept;
-    void unlockWIN32() noexcept;
-    void waitWIN32() noexcept;
-    void notifyAllWIN32() noexcept;
-#else
-   private:
-    void initPOSIX() noexcept;
-    void deinitPOSIX() noexcept;
-    void lockPOSIX() noexcept;
-    void unlockPOSIX() noexcept;
-    void waitPOSIX() noexcept;
-    void notifyAllPOSIX() noexcept;
-    bool validPOSIX() noexcept;
-
-    void initSysV() noexcept;
-    void deinitSysV() noexcept;
-    void lockSysV() noexcept;
-    void unlockSysV() noexcept;
-    void waitSysV() noexcept;
-    void notifyAllSysV() noexcept;
-    bool validSysV() noexcept;
-#endif
+    uint64_t skippedFrames() noexcept {
+        const uint64_t retVal{m_skipped};
+        m_skipped = 0;
+        return retVal;
+    }
 
    private:
-    std::string m_name{""};
-    std::string m_nameForTimeStamping{""};
-    uint32_t m_size{0};
-    char *m_sharedMemory{nullptr};
-    char *m_userAccessibleSharedMemory{nullptr};
-    bool m_hasOnlyAttachedToSharedMemory{false};
+    struct SharedMemoryRingHeader {
+        uint64_t __magic;
+        uint32_t __slots;
+        uint32_t __size;
+        std::atomic<uint64_t> __frameSequenceNumber;
+        std::atomic<uint32_t> __notification; // Futex word, incremented per frame.
+        std::atomic<uint32_t> __waiters;
+    };
+    struct SharedMemoryRingSlot {
+        std::atomic<uint64_t> __sequenceNumber; // 0 while being written.
+        std::atomic<int64_t> __sampleTimeStamp;
+    };
 
-    std::atomic<bool> m_broken{false};
-    std::atomic<bool> m_isLocked{false};
+    // Header and slot headers are padded to a cache line; frames start cache line aligned.
+    static constexpr std::size_t HEADER_SIZE{64};
+    static constexpr std::size_t SLOT_HEADER_SIZE{64};
+    static constexpr uint64_t MAGIC{0x474e524e4f554c43ull}; // "CLUONRNG"
+    static_assert(sizeof(SharedMemoryRingHeader) <= HEADER_SIZE, "Header of SharedMemoryRing too large.");
+    static_assert(sizeof(SharedMemoryRingSlot) <= SLOT_HEADER_SIZE, "Slot header of SharedMemoryRing too large.");
 
-#ifdef WIN32
-    HANDLE __conditionEvent{nullptr};
-    HANDLE __mutex{nullptr};
-    HANDLE __sharedMemory{nullptr};
-#else
-    int32_t m_fdForTimeStamping{-1};
+    static std::size_t slotSize(uint32_t size) noexcept {
+        return SLOT_HEADER_SIZE + ((static_cast<std::size_t>(size) + 63) & ~static_cast<std::size_t>(63));
+    }
 
-    bool m_usePOSIX{true};
+    SharedMemoryRingSlot *slotFor(uint64_t frameSequenceNumber) const noexcept {
+        return reinterpret_cast<SharedMemoryRingSlot *>(m_sharedMemory + HEADER_SIZE
+                                                        + static_cast<std::size_t>((frameSequenceNumber - 1) % m_slots) * slotSize(m_size));
+    }
 
-    // Member fields for POSIX-based shared memory.
-#if !defined(__NetBSD__) && !defined(__OpenBSD__)
+   private:
+    std::string m_name;
     int32_t m_fd{-1};
-    struct SharedMemoryHeader {
-        uint32_t __size;
-        pthread_mutex_t __mutex;
-        pthread_cond_t __condition;
-    };
-    SharedMemoryHeader *m_sharedMemoryHeader{nullptr};
-#endif
-
-    // Member fields for SysV-based shared memory.
-    key_t m_shmKeySysV{0};
-    key_t m_mutexKeySysV{0};
-    key_t m_conditionKeySysV{0};
-
-    int m_sharedMemoryIDSysV{-1};
-    int m_mutexIDSysV{-1};
-    int m_conditionIDSysV{-1};
-#endif
+    bool m_isCreator{false};
+    uint32_t m_slots{0};
+    uint32_t m_size{0};
+    std::size_t m_mappedSize{0};
+    char *m_sharedMemory{nullptr};
+    SharedMemoryRingHeader *m_header{nullptr};
+    uint64_t m_writing{0};
+    uint64_t m_reading{0};
+    uint64_t m_lastRead{0};
+    uint64_t m_skipped{0};
 };
 } // namespace cluon
 
@@ -10177,6 +12211,8 @@ inline std::pair<ssize_t, int32_t> UDPSender::send(std::string &&data) const noe
 #else
     #ifdef __linux__
         #include <linux/sockios.h>
+        #include <sys/epoll.h>
+        #include <sys/eventfd.h>
     #endif
 
     #include <arpa/inet.h>
@@ -10213,6 +12249,22 @@ inline UDPReceiver::UDPReceiver(const std::string &receiveFromAddress,
     , m_mreq()
     , m_readFromSocketThread()
     , m_delegate(std::move(delegate)) {
+    open(receiveFromAddress, receiveFromPort);
+}
+
+inline UDPReceiver::UDPReceiver(const std::string &receiveFromAddress,
+                         uint16_t receiveFromPort,
+                         std::function<void(std::string &&, const struct sockaddr_in &, std::chrono::system_clock::time_point &&)> delegate,
+                         uint16_t localSendFromPort) noexcept
+    : m_localSendFromPort(localSendFromPort)
+    , m_receiveFromAddress()
+    , m_mreq()
+    , m_readFromSocketThread()
+    , m_delegateWithAddress(std::move(delegate)) {
+    open(receiveFromAddress, receiveFromPort);
+}
+
+inline void UDPReceiver::open(const std::string &receiveFromAddress, uint16_t receiveFromPort) noexcept {
     // Decompose given address string to check validity with numerical IPv4 address.
     std::string tmp{cluon::getIPv4FromHostname(receiveFromAddress)};
     std::replace(tmp.begin(), tmp.end(), '.', ' ');
@@ -10387,19 +12439,26 @@ inline UDPReceiver::UDPReceiver(const std::string &receiveFromAddress,
 #endif
         }
 
+#ifdef __linux__
         if (!(m_socket < 0)) {
-            // Constructing the receiving thread could fail.
-            try {
-                m_readFromSocketThread = std::thread(&UDPReceiver::readFromSocket, this);
-
-                // Let the operating system spawn the thread.
-                using namespace std::literals::chrono_literals; // NOLINT
-                do { std::this_thread::sleep_for(1ms); } while (!m_readFromSocketThreadRunning.load());
-            } catch (...) { closeSocket(ECHILD); } // LCOV_EXCL_LINE
+            // Deliver the receive time stamp with each packet instead of querying it by ioctl afterwards.
+            int32_t YES_TIMESTAMP{1};
+            if (0 > ::setsockopt(m_socket, SOL_SOCKET, SO_TIMESTAMPNS, &YES_TIMESTAMP, sizeof(YES_TIMESTAMP))) {
+                std::cerr << "[cluon::UDPReceiver] Failed to enable SO_TIMESTAMPNS: " << ::strerror(errno) << std::endl; // LCOV_EXCL_LINE
+            }
+        }
+#endif
 
+        if (!(m_socket < 0)) {
+            // The pipeline must exist before the receiving thread adds entries to it.
             try {
-                m_pipeline = std::make_shared<cluon::NotifyingPipeline<PipelineEntry>>(
-                    [this](PipelineEntry &&entry) { this->m_delegate(std::move(entry.m_data), std::move(entry.m_from), std::move(entry.m_sampleTime)); });
+                m_pipeline = std::make_shared<cluon::NotifyingPipeline<PipelineEntry>>([this](PipelineEntry &&entry) {
+                    if (nullptr != this->m_delegateWithAddress) {
+                        this->m_delegateWithAddress(std::move(entry.m_data), entry.m_from, std::move(entry.m_sampleTime));
+                    } else {
+                        this->m_delegate(std::move(entry.m_data), std::string(this->senderToString(entry.m_from)), std::move(entry.m_sampleTime));
+                    }
+                });
                 if (m_pipeline) {
                     // Let the operating system spawn the thread.
                     using namespace std::literals::chrono_literals; // NOLINT
@@ -10407,6 +12466,25 @@ inline UDPReceiver::UDPReceiver(const std::string &receiveFromAddress,
                 }
             } catch (...) { closeSocket(ECHILD); } // LCOV_EXCL_LINE
         }
+
+        if (!(m_socket < 0)) {
+            // Constructing the receiving thread could fail.
+            try {
+#ifdef __linux__
+                if (createEventLoop()) {
+                    m_readFromSocketThread = std::thread(&UDPReceiver::readFromSocketBatched, this);
+                } else {
+                    m_readFromSocketThread = std::thread(&UDPReceiver::readFromSocket, this);
+                }
+#else
+                m_readFromSocketThread = std::thread(&UDPReceiver::readFromSocket, this);
+#endif
+
+                // Let the operating system spawn the thread.
+                using namespace std::literals::chrono_literals; // NOLINT
+                do { std::this_thread::sleep_for(1ms); } while (!m_readFromSocketThreadRunning.load());
+            } catch (...) { closeSocket(ECHILD); } // LCOV_EXCL_LINE
+        }
     }
 }
 
@@ -10414,6 +12492,16 @@ inline UDPReceiver::~UDPReceiver() noexcept {
     {
         m_readFromSocketThreadRunning.store(false);
 
+#ifdef __linux__
+        // Wake up the receiving thread from epoll_wait.
+        if (!(m_wakeUpFD < 0)) {
+            const uint64_t ONE{1};
+            if (sizeof(ONE) != ::write(m_wakeUpFD, &ONE, sizeof(ONE))) {
+                std::cerr << "[cluon::UDPReceiver] Failed to wake up the receiving thread: " << ::strerror(errno) << std::endl; // LCOV_EXCL_LINE
+            }
+        }
+#endif
+
         // Joining the thread could fail.
         try {
             if (m_readFromSocketThread.joinable()) {
@@ -10424,6 +12512,17 @@ inline UDPReceiver::~UDPReceiver() noexcept {
 
     m_pipeline.reset();
 
+#ifdef __linux__
+    if (!(m_epollFD < 0)) {
+        ::close(m_epollFD);
+        m_epollFD = -1;
+    }
+    if (!(m_wakeUpFD < 0)) {
+        ::close(m_wakeUpFD);
+        m_wakeUpFD = -1;
+    }
+#endif
+
     closeSocket(0);
 }
 
@@ -10476,9 +12575,6 @@ inline void UDPReceiver::readFromSocket() noexcept {
     fd_set setOfFiledescriptorsToReadFrom{};
 
     // Sender address and port.
-    constexpr uint16_t MAX_ADDR_SIZE{1024};
-    std::array<char, MAX_ADDR_SIZE> remoteAddress{};
-
     struct sockaddr_storage remote {};
     socklen_t addrLength{sizeof(remote)};
 
@@ -10507,7 +12603,7 @@ inline void UDPReceiver::readFromSocket() noexcept {
                                        reinterpret_cast<struct sockaddr *>(&remote), // NOLINT
                                        reinterpret_cast<socklen_t *>(&addrLength));  // NOLINT
 
-                if ((0 < bytesRead) && (nullptr != m_delegate)) {
+                if ((0 < bytesRead) && hasDelegate()) {
 #ifdef __linux__
                     std::chrono::system_clock::time_point timestamp;
                     struct timeval receivedTimeStamp {};
@@ -10524,11 +12620,6 @@ inline void UDPReceiver::readFromSocket() noexcept {
                     std::chrono::system_clock::time_point timestamp = std::chrono::system_clock::now();
 #endif
 
-                    // Transform sender address to C-string.
-                    ::inet_ntop(remote.ss_family,
-                                &((reinterpret_cast<struct sockaddr_in *>(&remote))->sin_addr), // NOLINT
-                                remoteAddress.data(),
-                                remoteAddress.max_size());
                     const unsigned long RECVFROM_IP{reinterpret_cast<struct sockaddr_in *>(&remote)->sin_addr.s_addr}; // NOLINT
                     const uint16_t RECVFROM_PORT{ntohs(reinterpret_cast<struct sockaddr_in *>(&remote)->sin_port)};    // NOLINT
 
@@ -10544,7 +12635,7 @@ inline void UDPReceiver::readFromSocket() noexcept {
                     if (!sentFromUs) {
                         PipelineEntry pe;
                         pe.m_data       = std::string(buffer.data(), static_cast<size_t>(bytesRead));
-                        pe.m_from       = std::string(remoteAddress.data()) + ':' + std::to_string(RECVFROM_PORT);
+                        pe.m_from       = *reinterpret_cast<struct sockaddr_in *>(&remote); // NOLINT
                         pe.m_sampleTime = timestamp;
 
                         // Store entry in queue.
@@ -10564,6 +12655,156 @@ inline void UDPReceiver::readFromSocket() noexcept {
         }
     }
 }
+
+inline bool UDPReceiver::hasDelegate() const noexcept {
+    return (nullptr != m_delegate) || (nullptr != m_delegateWithAddress);
+}
+
+inline const std::string &UDPReceiver::senderToString(const struct sockaddr_in &sender) noexcept {
+    // Consecutive packets mostly come from the same sender.
+    if (m_lastSenderAsString.empty() || (sender.sin_addr.s_addr != m_lastSender.sin_addr.s_addr) || (sender.sin_port != m_lastSender.sin_port)) {
+        std::array<char, INET_ADDRSTRLEN> address{};
+        ::inet_ntop(AF_INET, &(sender.sin_addr), address.data(), address.max_size());
+        m_lastSender         = sender;
+        m_lastSenderAsString = std::string(address.data()) + ':' + std::to_string(ntohs(sender.sin_port));
+    }
+    return m_lastSenderAsString;
+}
+
+#ifdef __linux__
+inline bool UDPReceiver::createEventLoop() noexcept {
+    m_wakeUpFD = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    m_epollFD  = ::epoll_create1(EPOLL_CLOEXEC);
+
+    bool retVal = !(m_wakeUpFD < 0) && !(m_epollFD < 0);
+    if (retVal) {
+        struct epoll_event event {};
+        event.events  = EPOLLIN;
+        event.data.fd = m_socket;
+        retVal        = (0 == ::epoll_ctl(m_epollFD, EPOLL_CTL_ADD, m_socket, &event));
+        event.data.fd = m_wakeUpFD;
+        retVal        = retVal && (0 == ::epoll_ctl(m_epollFD, EPOLL_CTL_ADD, m_wakeUpFD, &event));
+    }
+
+    if (!retVal) {
+        std::cerr << "[cluon::UDPReceiver] Failed to set up epoll, falling back to select: " << ::strerror(errno) << std::endl; // LCOV_EXCL_LINE
+        if (!(m_epollFD < 0)) {                                                                                                  // LCOV_EXCL_LINE
+            ::close(m_epollFD);                                                                                                  // LCOV_EXCL_LINE
+        }
+        if (!(m_wakeUpFD < 0)) { // LCOV_EXCL_LINE
+            ::close(m_wakeUpFD); // LCOV_EXCL_LINE
+        }
+        m_epollFD  = -1; // LCOV_EXCL_LINE
+        m_wakeUpFD = -1; // LCOV_EXCL_LINE
+    }
+    return retVal;
+}
+
+inline void UDPReceiver::readFromSocketBatched() noexcept {
+    constexpr uint16_t MAX_LENGTH = static_cast<uint16_t>(UDPPacketSizeConstraints::MAX_SIZE_UDP_PACKET)
+                                    - static_cast<uint16_t>(UDPPacketSizeConstraints::SIZE_IPv4_HEADER)
+                                    - static_cast<uint16_t>(UDPPacketSizeConstraints::SIZE_UDP_HEADER);
+    // Number of packets read per call to recvmmsg.
+    constexpr std::size_t BATCH_SIZE{32};
+    // Room for the SCM_TIMESTAMPNS control message of one packet.
+    constexpr std::size_t CONTROL_LENGTH{CMSG_SPACE(sizeof(struct timespec))};
+
+    // One buffer, one sender address, and one control message buffer per packet of a batch.
+    std::vector<char> buffers(BATCH_SIZE * MAX_LENGTH);
+    std::vector<char> controls(BATCH_SIZE * CONTROL_LENGTH);
+    std::array<struct sockaddr_in, BATCH_SIZE> senders{};
+    std::array<struct iovec, BATCH_SIZE> iovecs{};
+    std::array<struct mmsghdr, BATCH_SIZE> messages{};
+    for (std::size_t i{0}; i < BATCH_SIZE; i++) {
+        iovecs[i].iov_base              = &buffers[i * MAX_LENGTH];
+        iovecs[i].iov_len               = MAX_LENGTH;
+        messages[i].msg_hdr.msg_iov     = &iovecs[i];
+        messages[i].msg_hdr.msg_iovlen  = 1;
+        messages[i].msg_hdr.msg_name    = &senders[i];
+        messages[i].msg_hdr.msg_control = &controls[i * CONTROL_LENGTH];
+    }
+
+    std::array<struct epoll_event, 2> events{};
+
+    // Indicate to main thread that we are ready.
+    m_readFromSocketThreadRunning.store(true);
+
+    while (m_readFromSocketThreadRunning.load()) {
+        // Sleep until data arrives or the destructor writes to m_wakeUpFD.
+        const int32_t numberOfEvents{::epoll_wait(m_epollFD, events.data(), static_cast<int>(events.size()), -1)};
+        bool socketIsReadable{false};
+        for (int32_t i{0}; i < numberOfEvents; i++) {
+            socketIsReadable |= (events[static_cast<std::size_t>(i)].data.fd == m_socket);
+        }
+        if (!socketIsReadable) {
+            continue;
+        }
+
+        std::size_t entries{0};
+        int32_t received{0};
+        do {
+            // recvmmsg overwrites the lengths of the sender addresses and the control messages.
+            for (auto &message : messages) {
+                message.msg_hdr.msg_namelen    = sizeof(struct sockaddr_in);
+                message.msg_hdr.msg_controllen = CONTROL_LENGTH;
+                message.msg_hdr.msg_flags      = 0;
+            }
+            received = ::recvmmsg(m_socket, messages.data(), BATCH_SIZE, MSG_DONTWAIT, nullptr);
+
+            for (int32_t i{0}; (i < received) && hasDelegate(); i++) {
+                const std::size_t INDEX{static_cast<std::size_t>(i)};
+                struct msghdr *header = &(messages[INDEX].msg_hdr);
+                if (0 == messages[INDEX].msg_len) {
+                    continue;
+                }
+
+                std::chrono::system_clock::time_point timestamp{};
+                bool hasTimestamp{false};
+                for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(header); nullptr != cmsg; cmsg = CMSG_NXTHDR(header, cmsg)) { // NOLINT
+                    if ((SOL_SOCKET == cmsg->cmsg_level) && (SCM_TIMESTAMPNS == cmsg->cmsg_type)) {
+                        struct timespec receivedTimeStamp {};
+                        std::memcpy(&receivedTimeStamp, CMSG_DATA(cmsg), sizeof(receivedTimeStamp)); // NOLINT
+                        // Transform struct timespec to C++ chrono.
+                        std::chrono::time_point<std::chrono::system_clock, std::chrono::nanoseconds> transformedTimePoint(
+                            std::chrono::nanoseconds(receivedTimeStamp.tv_sec * 1000000000L + receivedTimeStamp.tv_nsec));
+                        timestamp    = std::chrono::time_point_cast<std::chrono::system_clock::duration>(transformedTimePoint);
+                        hasTimestamp = true;
+                    }
+                }
+                if (!hasTimestamp) {
+                    timestamp = std::chrono::system_clock::now(); // LCOV_EXCL_LINE
+                }
+
+                const unsigned long RECVFROM_IP{senders[INDEX].sin_addr.s_addr};
+                const uint16_t RECVFROM_PORT{ntohs(senders[INDEX].sin_port)};
+
+                // Check if the bytes actually came from us.
+                bool sentFromUs{false};
+                {
+                    auto pos                   = m_listOfLocalIPAddresses.find(RECVFROM_IP);
+                    const bool sentFromLocalIP = (pos != m_listOfLocalIPAddresses.end() && (*pos == RECVFROM_IP));
+                    sentFromUs                 = sentFromLocalIP && (m_localSendFromPort == RECVFROM_PORT);
+                }
+
+                // Create a pipeline entry to be processed concurrently.
+                if (!sentFromUs && m_pipeline) {
+                    PipelineEntry pe;
+                    pe.m_data       = std::string(&buffers[INDEX * MAX_LENGTH], messages[INDEX].msg_len);
+                    pe.m_from       = senders[INDEX];
+                    pe.m_sampleTime = timestamp;
+                    m_pipeline->add(std::move(pe));
+                    entries++;
+                }
+            }
+            // A batch that is not full means that the socket has been drained.
+        } while (BATCH_SIZE == static_cast<std::size_t>(received));
+
+        if ((0 < entries) && m_pipeline) {
+            m_pipeline->notifyAll();
+        }
+    }
+}
+#endif
 } // namespace cluon
 /*
  * Copyright (C) 2017-2018  Christian Berger
@@ -10724,8 +12965,12 @@ inline void TCPConnection::startReadingFromSocket() noexcept {
     }
 
     try {
+        // TCP is a byte stream: dropping a chunk would corrupt the stream for the receiver,
+        // so the reading thread waits for the delegate instead (backpressure onto the socket).
         m_pipeline = std::make_shared<cluon::NotifyingPipeline<PipelineEntry>>(
-            [this](PipelineEntry &&entry) { this->m_newDataDelegate(std::move(entry.m_data), std::move(entry.m_sampleTime)); });
+            [this](PipelineEntry &&entry) { this->m_newDataDelegate(std::move(entry.m_data), std::move(entry.m_sampleTime)); },
+            cluon::NotifyingPipeline<PipelineEntry>::DEFAULT_CAPACITY,
+            cluon::NotifyingPipeline<PipelineEntry>::OverflowPolicy::BLOCK);
         if (m_pipeline) {
             // Let the operating system spawn the thread.
             using namespace std::literals::chrono_literals; // NOLINT
@@ -13940,21 +16185,48 @@ inline void ToMsgPackVisitor::visit(uint32_t id, std::string &&typeName, std::st
 
 namespace cluon {
 
-inline OD4Session::OD4Session(uint16_t CID, std::function<void(cluon::data::Envelope &&envelope)> delegate) noexcept
+inline OD4Session::OD4Session(uint16_t CID, std::function<void(cluon::data::Envelope &&envelope)> delegate, uint32_t numberOfDelegateWorkers) noexcept
     : m_receiver{nullptr}
     , m_sender{"225.0.0." + std::to_string(CID), 12175}
     , m_delegate(std::move(delegate))
     , m_mapOfDataTriggeredDelegatesMutex{}
-    , m_mapOfDataTriggeredDelegates{} {
+    , m_mapOfDataTriggeredDelegates{std::make_shared<const MapOfDataTriggeredDelegates>()}
+    , m_currentMapOfDataTriggeredDelegates{m_mapOfDataTriggeredDelegates} {
+    // The workers must exist before the first Envelope is received.
+    try {
+        for (uint32_t i{0}; i < numberOfDelegateWorkers; i++) {
+            // The pipeline only overflows with more than DEFAULT_CAPACITY busy queues on one
+            // worker; a queue dropped from it is scheduled again with its next Envelope.
+            m_delegateWorkers.emplace_back(std::make_unique<cluon::NotifyingPipeline<DelegateQueue *>>(
+                [this](DelegateQueue *&&queue) { this->runDelegateQueue(queue); },
+                cluon::NotifyingPipeline<DelegateQueue *>::DEFAULT_CAPACITY,
+                cluon::NotifyingPipeline<DelegateQueue *>::OverflowPolicy::DROP_NEWEST,
+                [](DelegateQueue *&&queue) {
+                    std::lock_guard<std::mutex> lck{queue->m_mutex};
+                    queue->m_scheduled = false;
+                }));
+        }
+    } catch (...) { // LCOV_EXCL_LINE
+        std::cerr << "[cluon::OD4Session]: Failed to start delegate workers; calling delegates from the receiving thread." << std::endl; // LCOV_EXCL_LINE
+        m_delegateWorkers.clear(); // LCOV_EXCL_LINE
+    }
+
     m_receiver = std::make_unique<cluon::UDPReceiver>(
         "225.0.0." + std::to_string(CID),
         12175,
-        [this](std::string &&data, std::string &&from, std::chrono::system_clock::time_point &&timepoint) {
-            this->callback(std::move(data), std::move(from), std::move(timepoint));
+        [this](std::string &&data, const struct sockaddr_in & /*from*/, std::chrono::system_clock::time_point &&timepoint) {
+            this->callback(std::move(data), std::move(timepoint));
         },
         m_sender.getSendFromPort() /* passing our local send from port to the UDPReceiver to filter out our own bytes */);
 }
 
+inline OD4Session::~OD4Session() noexcept {
+    // Stop receiving before the members used by callback() are destroyed.
+    m_receiver.reset();
+    // Envelopes still queued for delegate workers are discarded.
+    m_delegateWorkers.clear();
+}
+
 inline void OD4Session::timeTrigger(float freq, std::function<bool()> delegate) noexcept {
     if (nullptr != delegate) {
         bool delegateIsRunning{true};
@@ -13989,51 +16261,155 @@ inline bool OD4Session::dataTrigger(int32_t messageIdentifier, std::function<voi
     if (nullptr == m_delegate) {
         try {
             std::lock_guard<std::mutex> lck{m_mapOfDataTriggeredDelegatesMutex};
-            if ((nullptr == delegate) && (m_mapOfDataTriggeredDelegates.count(messageIdentifier) > 0)) {
-                auto element = m_mapOfDataTriggeredDelegates.find(messageIdentifier);
-                if (element != m_mapOfDataTriggeredDelegates.end()) {
-                    m_mapOfDataTriggeredDelegates.erase(element);
-                }
+            auto mapOfDataTriggeredDelegates = std::make_shared<MapOfDataTriggeredDelegates>(*std::atomic_load(&m_mapOfDataTriggeredDelegates));
+            if (nullptr == delegate) {
+                mapOfDataTriggeredDelegates->erase(messageIdentifier);
             } else {
-                m_mapOfDataTriggeredDelegates[messageIdentifier] = delegate;
+                (*mapOfDataTriggeredDelegates)[messageIdentifier] = std::move(delegate);
             }
+            std::atomic_store(&m_mapOfDataTriggeredDelegates, std::shared_ptr<const MapOfDataTriggeredDelegates>(std::move(mapOfDataTriggeredDelegates)));
+            m_mapOfDataTriggeredDelegatesVersion.fetch_add(1, std::memory_order_release);
             retVal = true;
         } catch (...) {} // LCOV_EXCL_LINE
     }
     return retVal;
 }
 
-inline void OD4Session::callback(std::string &&data, std::string && /*from*/, std::chrono::system_clock::time_point &&timepoint) noexcept {
-    size_t numberOfDataTriggeredDelegates{0};
+inline void OD4Session::callback(std::string &&data, std::chrono::system_clock::time_point &&timepoint) noexcept {
+    // Decode the Envelope's fields directly from the received bytes; the
+    // payload is only copied once the Envelope is known to be delivered.
+    EnvelopeView view;
+    if (!EnvelopeView::decode(data.data(), data.size(), view)) {
+        return;
+    }
+
+    // "Catch all"-delegate.
+    if (nullptr != m_delegate) {
+        cluon::data::Envelope env{view.envelope()};
+        env.received(cluon::time::convert(timepoint));
+        if (m_delegateWorkers.empty()) {
+            m_delegate(std::move(env));
+        } else {
+            dispatchToWorker(std::move(env), &m_delegate, nullptr);
+        }
+        return;
+    }
+
+    // Data triggered-delegates: reload the map only after dataTrigger() has
+    // published a new one; the map in use keeps its delegates alive.
+    const uint64_t VERSION{m_mapOfDataTriggeredDelegatesVersion.load(std::memory_order_acquire)};
+    if (VERSION != m_currentMapOfDataTriggeredDelegatesVersion) {
+        m_currentMapOfDataTriggeredDelegates        = std::atomic_load(&m_mapOfDataTriggeredDelegates);
+        m_currentMapOfDataTriggeredDelegatesVersion = VERSION;
+    }
+    auto element = m_currentMapOfDataTriggeredDelegates->find(view.m_dataType);
+    if (element != m_currentMapOfDataTriggeredDelegates->end()) {
+        cluon::data::Envelope env{view.envelope()};
+        env.received(cluon::time::convert(timepoint));
+        if (m_delegateWorkers.empty()) {
+            try {
+                element->second(std::move(env));
+            } catch (...) {} // LCOV_EXCL_LINE
+        } else {
+            dispatchToWorker(std::move(env), &(element->second), m_currentMapOfDataTriggeredDelegates);
+        }
+    }
+}
+
+inline void OD4Session::dispatchToWorker(cluon::data::Envelope &&envelope,
+                                         const std::function<void(cluon::data::Envelope &&envelope)> *delegate,
+                                         const std::shared_ptr<const MapOfDataTriggeredDelegates> &delegates) noexcept {
+    const uint64_t KEY{(static_cast<uint64_t>(static_cast<uint32_t>(envelope.dataType())) << 32) | envelope.senderStamp()};
+    auto entry = m_delegateQueues.find(KEY);
+    if (entry == m_delegateQueues.end()) {
+        try {
+            // Keys are dealt to the workers in the order they are first seen.
+            std::unique_ptr<DelegateQueue> queue{new DelegateQueue()};
+            queue->m_dataType    = envelope.dataType();
+            queue->m_senderStamp = envelope.senderStamp();
+            queue->m_worker      = static_cast<uint32_t>(m_delegateQueues.size() % m_delegateWorkers.size());
+
+            std::lock_guard<std::mutex> lck{m_delegateQueuesMutex};
+            entry = m_delegateQueues.emplace(KEY, std::move(queue)).first;
+        } catch (...) { return; } // LCOV_EXCL_LINE
+    }
+
+    DelegateQueue *queue{entry->second.get()};
+    bool schedule{false};
+    try {
+        DelegateJob job;
+        job.m_delegates = delegates;
+        job.m_delegate  = delegate;
+        job.m_envelope  = std::move(envelope);
+
+        std::lock_guard<std::mutex> lck{queue->m_mutex};
+        if (DELEGATE_QUEUE_CAPACITY <= queue->m_jobs.size()) {
+            // Only this dataType/senderStamp's own oldest Envelope makes room.
+            queue->m_jobs.pop_front();
+            queue->m_dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+        queue->m_jobs.push_back(std::move(job));
+        schedule           = !queue->m_scheduled;
+        queue->m_scheduled = true;
+    } catch (...) { return; } // LCOV_EXCL_LINE
+
+    if (schedule) {
+        auto &worker = m_delegateWorkers[queue->m_worker];
+        worker->add(std::move(queue));
+        worker->notifyAll();
+    }
+}
+
+inline void OD4Session::runDelegateQueue(DelegateQueue *queue) noexcept {
+    // Run one Envelope per turn so that the worker alternates between its busy queues.
+    DelegateJob job;
     {
-        try {
-            std::lock_guard<std::mutex> lck{m_mapOfDataTriggeredDelegatesMutex};
-            numberOfDataTriggeredDelegates = m_mapOfDataTriggeredDelegates.size();
-        } catch (...) {} // LCOV_EXCL_LINE
+        std::lock_guard<std::mutex> lck{queue->m_mutex};
+        if (queue->m_jobs.empty()) {
+            queue->m_scheduled = false; // LCOV_EXCL_LINE
+            return;                     // LCOV_EXCL_LINE
+        }
+        job = std::move(queue->m_jobs.front());
+        queue->m_jobs.pop_front();
     }
-    // Only unpack the envelope when it needs to be post-processed.
-    if ((nullptr != m_delegate) || (0 < numberOfDataTriggeredDelegates)) {
-        std::stringstream sstr(data);
-        auto retVal = extractEnvelope(sstr);
+    try {
+        (*job.m_delegate)(std::move(job.m_envelope));
+    } catch (...) {} // LCOV_EXCL_LINE
+    queue->m_delivered.fetch_add(1, std::memory_order_relaxed);
 
-        if (retVal.first) {
-            cluon::data::Envelope env{retVal.second};
-            env.received(cluon::time::convert(timepoint));
+    bool reschedule{false};
+    {
+        std::lock_guard<std::mutex> lck{queue->m_mutex};
+        reschedule         = !queue->m_jobs.empty();
+        queue->m_scheduled = reschedule;
+    }
+    if (reschedule) {
+        auto &worker = m_delegateWorkers[queue->m_worker];
+        worker->add(std::move(queue));
+        worker->notifyAll();
+    }
+}
 
-            // "Catch all"-delegate.
-            if (nullptr != m_delegate) {
-                m_delegate(std::move(env));
-            } else {
-                try {
-                    // Data triggered-delegates.
-                    std::lock_guard<std::mutex> lck{m_mapOfDataTriggeredDelegatesMutex};
-                    if (m_mapOfDataTriggeredDelegates.count(env.dataType()) > 0) {
-                        m_mapOfDataTriggeredDelegates[env.dataType()](std::move(env));
-                    }
-                } catch (...) {} // LCOV_EXCL_LINE
+inline std::vector<OD4Session::DelegateQueueStatistics> OD4Session::delegateQueueStatistics() const noexcept {
+    std::vector<DelegateQueueStatistics> statistics;
+    try {
+        std::lock_guard<std::mutex> lck{m_delegateQueuesMutex};
+        for (const auto &entry : m_delegateQueues) {
+            const DelegateQueue &queue{*entry.second};
+            DelegateQueueStatistics s;
+            s.m_dataType    = queue.m_dataType;
+            s.m_senderStamp = queue.m_senderStamp;
+            s.m_worker      = queue.m_worker;
+            s.m_delivered   = queue.m_delivered.load(std::memory_order_relaxed);
+            s.m_dropped     = queue.m_dropped.load(std::memory_order_relaxed);
+            {
+                std::lock_guard<std::mutex> queueLock{entry.second->m_mutex};
+                s.m_queued = queue.m_jobs.size();
             }
+            statistics.push_back(s);
         }
-    }
+    } catch (...) {} // LCOV_EXCL_LINE
+    return statistics;
 }
 
 inline void OD4Session::send(cluon::data::Envelope &&envelope) noexcept {
@@ -14357,44 +16733,100 @@ inline std::string EnvelopeConverter::getProtoEncodedEnvelopeFromJSON(const std:
 
 //#include "cluon/Player.hpp"
 //#include "cluon/Envelope.hpp"
+//#include "cluon/RecFileIndex.hpp"
 //#include "cluon/Time.hpp"
+//#include "cluon/stringtoolbox.hpp"
 
 #include <algorithm>
 #include <chrono>
 #include <cmath>
 #include <cstdio>
-#include <fstream>
 #include <iostream>
 #include <limits>
+#include <sstream>
+#include <string>
 #include <thread>
 #include <utility>
+#include <vector>
 
 namespace cluon {
 
-inline IndexEntry::IndexEntry(const int64_t &sampleTimeStamp, const uint64_t &filePosition) noexcept
+inline std::pair<bool, EnvelopeFilter> EnvelopeFilter::fromString(const std::string &list) noexcept {
+    bool retVal{true};
+    EnvelopeFilter filter;
+    try {
+        std::istringstream sstr(list);
+        std::string item;
+        while (std::getline(sstr, item, ',')) {
+            const std::string ITEM{stringtoolbox::trim(item)};
+            if (ITEM.empty()) {
+                continue;
+            }
+            const std::size_t SLASH{ITEM.find('/')};
+            std::size_t dataTypeLength{0};
+            const int32_t DATATYPE{std::stoi(ITEM.substr(0, SLASH), &dataTypeLength)};
+            retVal &= (dataTypeLength == ITEM.substr(0, SLASH).size());
+            if (std::string::npos == SLASH) {
+                filter.allow(DATATYPE);
+            } else {
+                std::size_t senderStampLength{0};
+                const uint32_t SENDERSTAMP{static_cast<uint32_t>(std::stoul(ITEM.substr(SLASH + 1), &senderStampLength))};
+                retVal &= (senderStampLength == ITEM.substr(SLASH + 1).size());
+                filter.allow(DATATYPE, SENDERSTAMP);
+            }
+        }
+    } catch (...) {
+        retVal = false;
+    }
+    return std::make_pair(retVal, filter);
+}
+
+inline EnvelopeFilter &EnvelopeFilter::allow(int32_t dataType) noexcept {
+    try {
+        m_dataTypes.insert(dataType);
+    } catch (...) {} // LCOV_EXCL_LINE
+    return *this;
+}
+
+inline EnvelopeFilter &EnvelopeFilter::allow(int32_t dataType, uint32_t senderStamp) noexcept {
+    try {
+        m_dataTypesAndSenderStamps.insert(std::make_pair(dataType, senderStamp));
+    } catch (...) {} // LCOV_EXCL_LINE
+    return *this;
+}
+
+inline bool EnvelopeFilter::acceptsAll() const noexcept {
+    return m_dataTypes.empty() && m_dataTypesAndSenderStamps.empty();
+}
+
+inline bool EnvelopeFilter::accepts(int32_t dataType, uint32_t senderStamp) const noexcept {
+    return acceptsAll() || (0 < m_dataTypes.count(dataType)) || (0 < m_dataTypesAndSenderStamps.count(std::make_pair(dataType, senderStamp)));
+}
+
+////////////////////////////////////////////////////////////////////////
+
+inline IndexEntry::IndexEntry(const int64_t &sampleTimeStamp, const uint64_t &filePosition, const int32_t &dataType, const uint32_t &senderStamp) noexcept
     : m_sampleTimeStamp(sampleTimeStamp)
     , m_filePosition(filePosition)
-    , m_available(false) {}
+    , m_dataType(dataType)
+    , m_senderStamp(senderStamp) {}
 
 ////////////////////////////////////////////////////////////////////////
 
-inline Player::Player(const std::string &file, const bool &autoRewind, const bool &threading) noexcept
+inline Player::Player(const std::string &file, const bool &autoRewind, const bool &threading, const EnvelopeFilter &filter) noexcept
     : m_threading(threading)
     , m_file(file)
-    , m_recFile()
+    , m_recFile(file)
     , m_recFileValid(false)
+    , m_filter(filter)
     , m_autoRewind(autoRewind)
-    , m_indexMutex()
     , m_index()
-    , m_previousPreviousEnvelopeAlreadyReplayed(m_index.end())
-    , m_previousEnvelopeAlreadyReplayed(m_index.begin())
-    , m_currentEnvelopeToReplay(m_index.begin())
-    , m_nextEntryToReadFromRecFile(m_index.begin())
+    , m_previousEnvelopeAlreadyReplayed(0)
+    , m_currentEnvelopeToReplay(0)
+    , m_nextEntryToReadFromRecFile(0)
     , m_desiredInitialLevel(0)
-    , m_firstTimePointReturningAEnvelope()
     , m_numberOfReturnedEnvelopesInTotal(0)
     , m_delay(0)
-    , m_envelopeCacheFillingThreadIsRunningMutex()
     , m_envelopeCacheFillingThreadIsRunning(false)
     , m_envelopeCacheFillingThread()
     , m_envelopeCache()
@@ -14416,8 +16848,6 @@ inline Player::~Player() {
         setEnvelopeCacheFillingRunning(false);
         m_envelopeCacheFillingThread.join();
     }
-
-    m_recFile.close();
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -14430,78 +16860,86 @@ inline void Player::setPlayerListener(std::function<void(cluon::data::PlayerStat
 ////////////////////////////////////////////////////////////////////////
 
 inline void Player::initializeIndex() noexcept {
-    m_recFile.open(m_file.c_str(), std::ios_base::in | std::ios_base::binary); /* Flawfinder: ignore */
-    m_recFileValid = m_recFile.good();
+    m_recFileValid = m_recFile.valid();
 
     if (m_recFileValid) {
-        // Determine file size to display progress.
-        m_recFile.seekg(0, m_recFile.end);
-        int64_t fileLength = m_recFile.tellg();
-        m_recFile.seekg(0, m_recFile.beg);
-
-        // Read complete file and store file positions to envelopes to create
-        // index of available data. The actual reading of Envelopes is deferred.
-        uint64_t totalBytesRead = 0;
-        const cluon::data::TimeStamp BEFORE{cluon::time::now()};
-        {
-            int32_t oldPercentage = -1;
-            while (m_recFile.good()) {
-                const uint64_t POS_BEFORE = static_cast<uint64_t>(m_recFile.tellg());
-                auto retVal               = extractEnvelope(m_recFile);
-                const uint64_t POS_AFTER  = static_cast<uint64_t>(m_recFile.tellg());
-
-                if (!m_recFile.eof() && retVal.first) {
-                    totalBytesRead += (POS_AFTER - POS_BEFORE);
-
-                    // Store mapping .rec file position --> index entry.
-                    const int64_t microseconds = cluon::time::toMicroseconds(retVal.second.sampleTimeStamp());
-                    m_index.emplace(std::make_pair(microseconds, IndexEntry(microseconds, POS_BEFORE)));
-
-                    const int32_t percentage = static_cast<int32_t>((static_cast<float>(m_recFile.tellg()) * 100.0f) / static_cast<float>(fileLength));
-                    if ((percentage % 5 == 0) && (percentage != oldPercentage)) {
-                        std::clog << "[cluon::Player]: Indexed " << percentage << "% from " << m_file << "." << std::endl;
-                        oldPercentage = percentage;
-                    }
-                }
-            }
+        if (!loadIndexFromIndexFile()) {
+            createIndexFromRecFile();
         }
-        const cluon::data::TimeStamp AFTER{cluon::time::now()};
-
-        std::clog << "[cluon::Player]: " << m_file << " contains " << m_index.size() << " entries; "
-                  << "read " << totalBytesRead << " bytes "
-                  << "in " << cluon::time::deltaInMicroseconds(AFTER, BEFORE) / static_cast<int64_t>(1000 * 1000) << "s." << std::endl;
     } else {
         std::clog << "[cluon::Player]: " << m_file << " could not be opened." << std::endl;
     }
 }
 
-inline void Player::resetCaches() noexcept {
-    try {
-        std::lock_guard<std::mutex> lck(m_indexMutex);
-        m_delay                            = 0;
-        m_numberOfReturnedEnvelopesInTotal = 0;
-        m_envelopeCache.clear();
-    } catch (...) {} // LCOV_EXCL_LINE
+inline bool Player::loadIndexFromIndexFile() noexcept {
+    const cluon::data::TimeStamp BEFORE{cluon::time::now()};
+    RecFileIndex indexFile(m_file);
+    if (!indexFile.valid()) {
+        return false;
+    }
+
+    // The entries are stored in the order of the global index.
+    m_index.reserve(static_cast<std::size_t>(indexFile.size()));
+    for (uint64_t i{0}; i < indexFile.size(); i++) {
+        addToIndex(indexFile.at(i));
+    }
+    m_index.shrink_to_fit();
+    const cluon::data::TimeStamp AFTER{cluon::time::now()};
+
+    std::clog << "[cluon::Player]: " << m_file << " contains " << indexFile.size() << " entries; "
+              << "loaded index from " << RecFileIndex::indexFileFor(m_file) << " "
+              << "in " << cluon::time::deltaInMicroseconds(AFTER, BEFORE) / static_cast<int64_t>(1000) << "ms." << std::endl;
+    if (!m_filter.acceptsAll()) {
+        std::clog << "[cluon::Player]: Replaying " << m_index.size() << " entries matching the filter." << std::endl;
+    }
+    return true;
 }
 
-inline void Player::resetIterators() noexcept {
-    try {
-        std::lock_guard<std::mutex> lck(m_indexMutex);
-        // Point to first entry in index.
-        m_nextEntryToReadFromRecFile = m_previousEnvelopeAlreadyReplayed = m_currentEnvelopeToReplay = m_index.begin();
-        // Invalidate iterator for erasing entries point.
-        m_previousPreviousEnvelopeAlreadyReplayed = m_index.end();
-    } catch (...) {} // LCOV_EXCL_LINE
+inline void Player::createIndexFromRecFile() noexcept {
+    // Scan the memory-mapped file in parallel and store file positions to envelopes
+    // to create index of available data. Only the Envelope fields needed for the
+    // index are decoded; the actual reading of Envelopes is deferred.
+    uint64_t totalBytesRead = 0;
+    const cluon::data::TimeStamp BEFORE{cluon::time::now()};
+    const std::vector<RecFileIndex::Entry> ENTRIES{RecFileIndex::scan(m_recFile, 0, totalBytesRead)};
+    for (const RecFileIndex::Entry &e : ENTRIES) {
+        // Store mapping .rec file position --> index entry; entries are sorted already.
+        addToIndex(e);
+    }
+    const cluon::data::TimeStamp AFTER{cluon::time::now()};
+
+    std::clog << "[cluon::Player]: " << m_file << " contains " << ENTRIES.size() << " entries; "
+              << "read " << totalBytesRead << " bytes "
+              << "in " << cluon::time::deltaInMicroseconds(AFTER, BEFORE) / static_cast<int64_t>(1000) << "ms." << std::endl;
+    if (!m_filter.acceptsAll()) {
+        std::clog << "[cluon::Player]: Replaying " << m_index.size() << " entries matching the filter." << std::endl;
+    }
+
+    // A missing index file only costs the scan above the next time.
+    if (!RecFileIndex::write(m_file, ENTRIES)) {
+        std::clog << "[cluon::Player]: Could not write index file " << RecFileIndex::indexFileFor(m_file) << "." << std::endl;
+    }
+}
+
+inline void Player::addToIndex(const RecFileIndex::Entry &e) noexcept {
+    // The sidecar index always lists all entries so that it can be shared between filters.
+    if (m_filter.accepts(e.m_dataType, e.m_senderStamp)) {
+        m_index.emplace_back(e.m_sampleTimeStamp, e.m_filePosition, e.m_dataType, e.m_senderStamp);
+    }
+}
+
+inline void Player::resetCacheTo(std::size_t entry) noexcept {
+    m_envelopeCache.reset(m_desiredInitialLevel);
+    m_delay = 0;
+    // Point to the given entry in index.
+    m_nextEntryToReadFromRecFile = m_previousEnvelopeAlreadyReplayed = m_currentEnvelopeToReplay = entry;
 }
 
 inline void Player::computeInitialCacheLevelAndFillCache() noexcept {
     if (m_recFileValid && (m_index.size() > 0)) {
-        int64_t smallestSampleTimePoint = (std::numeric_limits<int64_t>::max)();
-        int64_t largestSampleTimePoint  = (std::numeric_limits<int64_t>::min)();
-        for (auto it = m_index.begin(); it != m_index.end(); it++) {
-            smallestSampleTimePoint = (std::min)(smallestSampleTimePoint, it->first);
-            largestSampleTimePoint  = (std::max)(largestSampleTimePoint, it->first);
-        }
+        // The index is sorted by sample time stamp.
+        const int64_t smallestSampleTimePoint = m_index.front().m_sampleTimeStamp;
+        const int64_t largestSampleTimePoint  = m_index.back().m_sampleTimeStamp;
 
         const uint32_t ENTRIES_TO_READ_PER_SECOND_FOR_REALTIME_REPLAY
             = static_cast<uint32_t>(std::ceil(static_cast<float>(m_index.size()) * (static_cast<float>(Player::ONE_SECOND_IN_MICROSECONDS))
@@ -14510,35 +16948,28 @@ inline void Player::computeInitialCacheLevelAndFillCache() noexcept {
 
         std::clog << "[cluon::Player]: Initializing cache with " << m_desiredInitialLevel << " entries." << std::endl;
 
-        resetCaches();
-        resetIterators();
+        m_numberOfReturnedEnvelopesInTotal = 0;
+        resetCacheTo(0);
         fillEnvelopeCache(m_desiredInitialLevel);
     }
 }
 
 inline uint32_t Player::fillEnvelopeCache(const uint32_t &maxNumberOfEntriesToReadFromFile) noexcept {
     uint32_t entriesReadFromFile = 0;
-    if (m_recFileValid && (maxNumberOfEntriesToReadFromFile > 0)) {
-        // Reset any fstream's error states.
-        m_recFile.clear();
-
-        while ((m_nextEntryToReadFromRecFile != m_index.end()) && (entriesReadFromFile < maxNumberOfEntriesToReadFromFile)) {
-            // Move to corresponding position in the .rec file.
-            m_recFile.seekg(static_cast<std::streamoff>(m_nextEntryToReadFromRecFile->second.m_filePosition));
-
-            // Read the corresponding cluon::data::Envelope.
-            auto retVal = extractEnvelope(m_recFile);
-            if (retVal.first) {
-                // Store the envelope in the envelope cache.
-                try {
-                    std::lock_guard<std::mutex> lck(m_indexMutex);
-                    m_nextEntryToReadFromRecFile->second.m_available
-                        = m_envelopeCache.emplace(std::make_pair(m_nextEntryToReadFromRecFile->second.m_filePosition, retVal.second)).second;
-                } catch (...) {} // LCOV_EXCL_LINE
-
-                m_nextEntryToReadFromRecFile++;
-                entriesReadFromFile++;
+    if (m_recFileValid) {
+        EnvelopeView view;
+        while ((m_nextEntryToReadFromRecFile < m_index.size()) && (entriesReadFromFile < maxNumberOfEntriesToReadFromFile) && !m_envelopeCache.full()) {
+            // Read the corresponding cluon::data::Envelope from the mapped .rec file;
+            // an Envelope that cannot be read anymore is replayed as an empty one to
+            // keep the cache in line with the global index.
+            cluon::data::Envelope envelope;
+            if (m_recFile.viewAt(m_index[m_nextEntryToReadFromRecFile].m_filePosition, view)) {
+                envelope = view.envelope();
             }
+            m_envelopeCache.push(std::move(envelope));
+
+            m_nextEntryToReadFromRecFile++;
+            entriesReadFromFile++;
         }
     }
 
@@ -14550,7 +16981,7 @@ inline std::pair<bool, cluon::data::Envelope> Player::getNextEnvelopeToBeReplaye
     cluon::data::Envelope envelopeToReturn;
 
     // If at "EOF", either throw exception or autorewind.
-    if (m_currentEnvelopeToReplay == m_index.end()) {
+    if (m_currentEnvelopeToReplay == m_index.size()) {
         if (!m_autoRewind) {
             return std::make_pair(hasEnvelopeToReturn, envelopeToReturn);
         } else {
@@ -14558,71 +16989,47 @@ inline std::pair<bool, cluon::data::Envelope> Player::getNextEnvelopeToBeReplaye
         }
     }
 
-    if (m_currentEnvelopeToReplay != m_index.end()) {
+    if (m_currentEnvelopeToReplay < m_index.size()) {
         checkAvailabilityOfNextEnvelopeToBeReplayed();
 
-        try {
-            {
-                std::lock_guard<std::mutex> lck(m_indexMutex);
-
-                cluon::data::Envelope &nextEnvelope = m_envelopeCache[m_currentEnvelopeToReplay->second.m_filePosition];
-                envelopeToReturn                    = nextEnvelope;
-
-                m_delay = static_cast<uint32_t>(m_currentEnvelopeToReplay->first - m_previousEnvelopeAlreadyReplayed->first);
-
-                // TODO: Delegate deleting into own thread.
-                if (m_previousPreviousEnvelopeAlreadyReplayed != m_index.end()) {
-                    auto it = m_envelopeCache.find(m_previousEnvelopeAlreadyReplayed->second.m_filePosition);
-                    if (it != m_envelopeCache.end()) {
-                        m_envelopeCache.erase(it);
-                    }
-                }
-
-                m_previousPreviousEnvelopeAlreadyReplayed = m_previousEnvelopeAlreadyReplayed;
-                m_previousEnvelopeAlreadyReplayed         = m_currentEnvelopeToReplay++;
+        // The cache holds the envelopes in the order of the index.
+        m_envelopeCache.pop(envelopeToReturn);
 
-                m_numberOfReturnedEnvelopesInTotal++;
-            }
+        m_delay = static_cast<uint32_t>(m_index[m_currentEnvelopeToReplay].m_sampleTimeStamp
+                                        - m_index[m_previousEnvelopeAlreadyReplayed].m_sampleTimeStamp);
+        m_previousEnvelopeAlreadyReplayed = m_currentEnvelopeToReplay++;
+        m_numberOfReturnedEnvelopesInTotal++;
 
-            // TODO compensate for internal data processing.
+        // TODO compensate for internal data processing.
 
-            // If Player is non-threaded, read next entry sequentially.
-            if (!m_threading) {
-                fillEnvelopeCache(1);
-            }
+        // If Player is non-threaded, read next entry sequentially.
+        if (!m_threading) {
+            fillEnvelopeCache(1);
+        }
 
-            // Store sample time stamp as int64 to avoid unnecessary copying of Envelopes.
-            hasEnvelopeToReturn = true;
-        } catch (...) {} // LCOV_EXCL_LINE
+        hasEnvelopeToReturn = true;
     }
     return std::make_pair(hasEnvelopeToReturn, envelopeToReturn);
 }
 
 inline void Player::checkAvailabilityOfNextEnvelopeToBeReplayed() noexcept {
-    uint64_t numberOfEntries = 0;
-    do {
-        {
-            try {
-                std::lock_guard<std::mutex> lck(m_indexMutex);
-                numberOfEntries = m_envelopeCache.size();
-            } catch (...) {} // LCOV_EXCL_LINE
-        }
-        if (0 == numberOfEntries) {
+    while (0 == m_envelopeCache.size()) {
+        if (!m_threading) {
+            fillEnvelopeCache(1);
+        } else {
             using namespace std::chrono_literals; // LCOV_EXCL_LINE
-            std::this_thread::sleep_for(10ms);    // LCOV_EXCL_LINE
+            std::this_thread::sleep_for(1ms);     // LCOV_EXCL_LINE
         }
-    } while (0 == numberOfEntries);
+    }
 }
 
 ////////////////////////////////////////////////////////////////////////
 
 inline uint32_t Player::totalNumberOfEnvelopesInRecFile() const noexcept {
-    std::lock_guard<std::mutex> lck(m_indexMutex);
     return static_cast<uint32_t>(m_index.size());
 }
 
 inline uint32_t Player::delay() const noexcept {
-    std::lock_guard<std::mutex> lck(m_indexMutex);
     // Make sure that delay is not exceeding the specified maximum delay.
     return std::min<uint32_t>(m_delay, Player::MAX_DELAY_IN_MICROSECONDS);
 }
@@ -14645,61 +17052,55 @@ inline void Player::rewind() noexcept {
 
 inline void Player::seekTo(float ratio) noexcept {
     if (!(ratio < 0) && !(ratio > 1)) {
-        bool enableThreading = m_threading;
-        if (m_threading) {
-            // Stop concurrent thread.
-            setEnvelopeCacheFillingRunning(false);
-            m_envelopeCacheFillingThread.join();
-        }
-
-        // Read data sequentially.
-        m_threading = false;
-
-        resetCaches();
-        resetIterators();
-
-        uint32_t numberOfEntriesInIndex = 0;
-        try {
-            std::lock_guard<std::mutex> lck(m_indexMutex);
-            numberOfEntriesInIndex = static_cast<uint32_t>(m_index.size());
-        } catch (...) {} // LCOV_EXCL_LINE
-
-        // Fast forward.
-        m_numberOfReturnedEnvelopesInTotal = 0;
+        const uint32_t numberOfEntriesInIndex = static_cast<uint32_t>(m_index.size());
         std::clog << "[cluon::Player]: Seeking to " << static_cast<float>(numberOfEntriesInIndex) * ratio << "/" << numberOfEntriesInIndex << std::endl;
-        if (0 < ratio) {
-            for (m_numberOfReturnedEnvelopesInTotal = 0;
-                 m_numberOfReturnedEnvelopesInTotal < static_cast<uint32_t>(static_cast<float>(numberOfEntriesInIndex) * ratio) - 1;
-                 m_numberOfReturnedEnvelopesInTotal++) {
-                m_currentEnvelopeToReplay++;
-            }
-        }
-        try {
-            std::lock_guard<std::mutex> lck(m_indexMutex);
-            m_nextEntryToReadFromRecFile = m_previousEnvelopeAlreadyReplayed = m_currentEnvelopeToReplay;
-        } catch (...) {} // LCOV_EXCL_LINE
 
-        // Refill cache.
-        m_envelopeCache.clear();
-        fillEnvelopeCache(static_cast<uint32_t>(static_cast<float>(m_desiredInitialLevel) * .3f));
+        // Continue right before the requested entry as the entry itself is consumed below.
+        const uint32_t requestedEntry = static_cast<uint32_t>(static_cast<float>(numberOfEntriesInIndex) * ratio);
+        seekToEntry((0 < ratio) && (0 < requestedEntry) ? requestedEntry - 1 : 0);
 
         // Correct iterators if not at the beginning.
         if ((0 < ratio) && (ratio < 1)) {
             getNextEnvelopeToBeReplayed();
         }
         std::clog << "[cluon::Player]: Seeking done." << std::endl;
+    }
+}
 
-        if (enableThreading) {
-            m_threading = enableThreading;
-            // Re-start concurrent thread.
-            setEnvelopeCacheFillingRunning(true);
-            m_envelopeCacheFillingThread = std::thread(&Player::manageCache, this);
-        }
+inline void Player::seekToSampleTimeStamp(const cluon::data::TimeStamp &sampleTimeStamp) noexcept {
+    const int64_t SAMPLE_TIME_STAMP{cluon::time::toMicroseconds(sampleTimeStamp)};
+    auto it = std::lower_bound(m_index.begin(), m_index.end(), SAMPLE_TIME_STAMP, [](const IndexEntry &e, int64_t timeStamp) {
+        return e.m_sampleTimeStamp < timeStamp;
+    });
+    seekToEntry(static_cast<std::size_t>(it - m_index.begin()));
+}
+
+inline void Player::seekToEntry(std::size_t entry) noexcept {
+    bool enableThreading = m_threading;
+    if (m_threading) {
+        // Stop concurrent thread.
+        setEnvelopeCacheFillingRunning(false);
+        m_envelopeCacheFillingThread.join();
+    }
+
+    // Read data sequentially.
+    m_threading = false;
+
+    resetCacheTo(std::min(entry, m_index.size()));
+    m_numberOfReturnedEnvelopesInTotal = m_currentEnvelopeToReplay;
+
+    // Refill cache.
+    fillEnvelopeCache(static_cast<uint32_t>(static_cast<float>(m_desiredInitialLevel) * .3f));
+
+    if (enableThreading) {
+        m_threading = enableThreading;
+        // Re-start concurrent thread.
+        setEnvelopeCacheFillingRunning(true);
+        m_envelopeCacheFillingThread = std::thread(&Player::manageCache, this);
     }
 }
 
 inline bool Player::hasMoreData() const noexcept {
-    std::lock_guard<std::mutex> lck(m_indexMutex);
     return hasMoreDataFromRecFile();
 }
 
@@ -14707,78 +17108,47 @@ inline bool Player::hasMoreDataFromRecFile() const noexcept {
     // File must be successfully opened AND
     //  the Player must be configured as m_autoRewind OR
     //  some entries are left to replay.
-    return (m_recFileValid && (m_autoRewind || (m_currentEnvelopeToReplay != m_index.end())));
+    return (m_recFileValid && (m_autoRewind || (m_currentEnvelopeToReplay < m_index.size())));
 }
 
 ////////////////////////////////////////////////////////////////////////
 
 inline void Player::setEnvelopeCacheFillingRunning(const bool &running) noexcept {
-    std::lock_guard<std::mutex> lck(m_envelopeCacheFillingThreadIsRunningMutex);
-    m_envelopeCacheFillingThreadIsRunning = running;
+    m_envelopeCacheFillingThreadIsRunning.store(running);
 }
 
 inline bool Player::isEnvelopeCacheFillingRunning() const noexcept {
-    std::lock_guard<std::mutex> lck(m_envelopeCacheFillingThreadIsRunningMutex);
-    return m_envelopeCacheFillingThreadIsRunning;
+    return m_envelopeCacheFillingThreadIsRunning.load();
 }
 
 inline void Player::manageCache() noexcept {
-    uint8_t statisticsCounter = 0;
-    float refillMultiplicator = 1.1f;
-    uint32_t numberOfEntries  = 0;
+    cluon::data::TimeStamp lastStatistics{cluon::time::now()};
 
     while (isEnvelopeCacheFillingRunning()) {
-        try {
-            std::lock_guard<std::mutex> lck(m_indexMutex);
-            numberOfEntries = static_cast<uint32_t>(m_envelopeCache.size());
-        } catch (...) {} // LCOV_EXCL_LINE
-
-        // Check if refilling of the cache is needed.
-        refillMultiplicator = checkRefillingCache(numberOfEntries, refillMultiplicator);
-        (void)refillMultiplicator;
-
-        // Manage cache at 10 Hz.
-        using namespace std::chrono_literals;
-        std::this_thread::sleep_for(100ms);
+        // Keep the cache filled; wait for the replay to make room if it is full.
+        if (0 == fillEnvelopeCache(Player::ENTRIES_PER_REFILL)) {
+            using namespace std::chrono_literals;
+            std::this_thread::sleep_for(10ms);
+        }
 
         // Publish some statistics at 1 Hz.
-        if (0 == ((++statisticsCounter) % 10)) {
-            uint64_t numberOfReturnedEnvelopesInTotal = 0;
-            uint32_t totalNumberOfEnvelopes           = 0;
-            try {
-                // m_numberOfReturnedEnvelopesInTotal is modified in a different thread.
-                std::lock_guard<std::mutex> lck(m_indexMutex);
-                numberOfReturnedEnvelopesInTotal = m_numberOfReturnedEnvelopesInTotal;
-                totalNumberOfEnvelopes           = static_cast<uint32_t>(m_index.size());
-            } catch (...) {} // LCOV_EXCL_LINE
-
+        const cluon::data::TimeStamp NOW{cluon::time::now()};
+        if (Player::ONE_SECOND_IN_MICROSECONDS <= cluon::time::deltaInMicroseconds(NOW, lastStatistics)) {
             try {
                 std::lock_guard<std::mutex> lck(m_playerListenerMutex);
                 if (nullptr != m_playerListener) {
                     cluon::data::PlayerStatus ps;
                     ps.state(2); // State: "playback"
-                    ps.numberOfEntries(totalNumberOfEnvelopes);
-                    ps.currentEntryForPlayback(static_cast<uint32_t>(numberOfReturnedEnvelopesInTotal));
+                    ps.numberOfEntries(static_cast<uint32_t>(m_index.size()));
+                    // m_numberOfReturnedEnvelopesInTotal is modified in a different thread.
+                    ps.currentEntryForPlayback(static_cast<uint32_t>(m_numberOfReturnedEnvelopesInTotal.load()));
                     m_playerListener(ps);
                 }
             } catch (...) {} // LCOV_EXCL_LINE
 
-            statisticsCounter = 0;
-        }
-    }
-}
-
-inline float Player::checkRefillingCache(const uint32_t &numberOfEntries, float refillMultiplicator) noexcept {
-    // If filling level is around 35%, pour in more from the recording.
-    if (numberOfEntries < 0.35 * m_desiredInitialLevel) {
-        const uint32_t entriesReadFromFile = fillEnvelopeCache(static_cast<uint32_t>(refillMultiplicator * static_cast<float>(m_desiredInitialLevel)));
-        if (entriesReadFromFile > 0) {
-            std::clog << "[cluon::Player]: Number of entries in cache: " << numberOfEntries << ". " << entriesReadFromFile << " added to cache. "
-                      << m_envelopeCache.size() << " entries available." << std::endl;
-            refillMultiplicator *= 1.25f;
+            lastStatistics = NOW;
         }
     }
-    return refillMultiplicator;
 }
 
 } // namespace cluon
@@ -14813,6 +17183,7 @@ inline float Player::checkRefillingCache(const uint32_t &numberOfEntries, float
 #include <cstring>
 #include <iostream>
 #include <fstream>
+#include <thread>
 
 #if !defined(__APPLE__) && !defined(__OpenBSD__) && (defined(_SEM_SEMUN_UNDEFINED) || !defined(__FreeBSD__))
 union semun {
@@ -14889,6 +17260,10 @@ inline SharedMemory::~SharedMemory() noexcept {
 #ifdef WIN32
     deinitWIN32();
 #else
+    // Do not let the writer wait for a consumer that is gone.
+    if (m_handshake) {
+        setHandshake(false);
+    }
     if (m_usePOSIX) {
         deinitPOSIX();
     } else {
@@ -14905,6 +17280,7 @@ inline void SharedMemory::lock() noexcept {
 #ifdef WIN32
     lockWIN32();
 #else
+    waitForFrameDone();
     if (m_usePOSIX) {
         lockPOSIX();
     } else {
@@ -14918,6 +17294,12 @@ inline void SharedMemory::unlock() noexcept {
 #ifdef WIN32
     unlockWIN32();
 #else
+    // The creating writer counts the frame while still holding the lock so that a
+    // consumer always reads a frame together with its frame sequence number.
+    if ((nullptr != m_frameSync) && !m_hasOnlyAttachedToSharedMemory) {
+        m_frameSync->__frameSequenceNumber.fetch_add(1);
+        m_frameCountedInUnlock = true;
+    }
     if (m_usePOSIX) {
         unlockPOSIX();
     } else {
@@ -14943,6 +17325,11 @@ inline void SharedMemory::notifyAll() noexcept {
 #ifdef WIN32
     notifyAllWIN32();
 #else
+    // Frames written without lock()/unlock() are counted here.
+    if ((nullptr != m_frameSync) && !m_frameCountedInUnlock) {
+        m_frameSync->__frameSequenceNumber.fetch_add(1);
+    }
+    m_frameCountedInUnlock = false;
     if (m_usePOSIX) {
         notifyAllPOSIX();
     } else {
@@ -15016,6 +17403,92 @@ inline std::pair<bool, cluon::data::TimeStamp> SharedMemory::getTimeStamp() noex
     return std::make_pair(retVal, sampleTimeStamp);
 }
 
+inline bool SharedMemory::hasFrameSequenceNumbers() const noexcept {
+#ifdef WIN32
+    return false;
+#else
+    return (nullptr != m_frameSync);
+#endif
+}
+
+inline uint64_t SharedMemory::frameSequenceNumber() const noexcept {
+    uint64_t retVal{0};
+#ifndef WIN32
+    if (nullptr != m_frameSync) {
+        retVal = m_frameSync->__frameSequenceNumber.load();
+    }
+#endif
+    return retVal;
+}
+
+inline uint64_t SharedMemory::skippedFrames() noexcept {
+    uint64_t retVal{0};
+#ifndef WIN32
+    if (nullptr != m_frameSync) {
+        const uint64_t CURRENT{m_frameSync->__frameSequenceNumber.load()};
+        if (CURRENT > m_lastFrameSequenceNumber + 1) {
+            retVal = CURRENT - m_lastFrameSequenceNumber - 1;
+        }
+        if (CURRENT > m_lastFrameSequenceNumber) {
+            m_lastFrameSequenceNumber = CURRENT;
+        }
+    }
+#endif
+    return retVal;
+}
+
+inline bool SharedMemory::setHandshake(bool enabled) noexcept {
+    bool retVal{false};
+#ifdef WIN32
+    (void)enabled;
+#else
+    if ((retVal = (nullptr != m_frameSync))) {
+        if (enabled) {
+            // Nothing is outstanding yet; the writer waits from the next frame on.
+            m_frameSync->__frameDone.store(m_frameSync->__frameSequenceNumber.load());
+        }
+        m_frameSync->__handshake.store(enabled ? HANDSHAKE_ON : HANDSHAKE_OFF);
+        m_handshake = enabled;
+    }
+#endif
+    return retVal;
+}
+
+inline void SharedMemory::frameDone(uint64_t frameSequenceNumber) noexcept {
+#ifdef WIN32
+    (void)frameSequenceNumber;
+#else
+    if (nullptr != m_frameSync) {
+        m_frameSync->__frameDone.store(frameSequenceNumber);
+    }
+#endif
+}
+
+inline bool SharedMemory::handshakeSuspended() const noexcept {
+    bool retVal{false};
+#ifndef WIN32
+    retVal = m_handshake && (nullptr != m_frameSync) && (HANDSHAKE_SUSPENDED == m_frameSync->__handshake.load());
+#endif
+    return retVal;
+}
+
+inline bool SharedMemory::waitForFrame(uint64_t frameSequenceNumber, const std::chrono::milliseconds &timeout) noexcept {
+    bool retVal{false};
+#ifdef WIN32
+    (void)frameSequenceNumber;
+    (void)timeout;
+#else
+    if (nullptr != m_frameSync) {
+        const auto DEADLINE = std::chrono::steady_clock::now() + timeout;
+        while (!(retVal = (m_frameSync->__frameSequenceNumber.load() > frameSequenceNumber)) && !m_broken.load()
+               && (std::chrono::steady_clock::now() < DEADLINE)) {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+#endif
+    return retVal;
+}
+
 inline bool SharedMemory::valid() noexcept {
     bool valid{!m_broken.load()};
     valid &= (nullptr != m_sharedMemory);
@@ -15269,9 +17742,10 @@ inline void SharedMemory::initPOSIX() noexcept {
     if (-1 != m_fd) {
         bool retVal{true};
 
-        // When creating a shared memory segment, truncate it.
+        // When creating a shared memory segment, truncate it; the frame synchronisation block follows the user data.
+        m_mappedSize = (0 < m_size) ? sizeof(SharedMemoryHeader) + frameSyncOffset(m_size) + sizeof(SharedMemoryFrameSync) : sizeof(SharedMemoryHeader);
         if (0 < m_size) {
-            retVal = (0 == ::ftruncate(m_fd, static_cast<off_t>(sizeof(SharedMemoryHeader) + m_size)));
+            retVal = (0 == ::ftruncate(m_fd, static_cast<off_t>(m_mappedSize)));
             if (!retVal) {
 // clang-format off // LCOV_EXCL_LINE
                 std::cerr << "[cluon::SharedMemory (POSIX)] Failed to truncate '" << m_name << "': " << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
@@ -15282,7 +17756,7 @@ inline void SharedMemory::initPOSIX() noexcept {
         // Accessing shared memory segment.
         if (retVal) {
             // On opening (i.e., NOT creating) a shared memory segment, m_size is still 0 and we need to figure out the size first.
-            m_sharedMemory = static_cast<char *>(::mmap(0, sizeof(SharedMemoryHeader) + m_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0));
+            m_sharedMemory = static_cast<char *>(::mmap(0, m_mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0));
             if (MAP_FAILED != m_sharedMemory) {
                 m_sharedMemoryHeader = reinterpret_cast<SharedMemoryHeader *>(m_sharedMemory);
 
@@ -15312,6 +17786,8 @@ inline void SharedMemory::initPOSIX() noexcept {
                     ::pthread_condattr_setpshared(&conditionAttribute, PTHREAD_PROCESS_SHARED); // Share between unrelated processes.
                     ::pthread_cond_init(&(m_sharedMemoryHeader->__condition), &conditionAttribute);
                     ::pthread_condattr_destroy(&conditionAttribute);
+
+                    createFrameSync(m_sharedMemory + sizeof(SharedMemoryHeader) + frameSyncOffset(m_size));
                 } else {
                     // Indicate that this instance is attaching to an existing shared memory segment.
                     m_hasOnlyAttachedToSharedMemory = true;
@@ -15320,7 +17796,7 @@ inline void SharedMemory::initPOSIX() noexcept {
                     m_size = m_sharedMemoryHeader->__size;
 
                     // Now, as we know the real size, unmap the first mapping that did not know the size.
-                    if (::munmap(m_sharedMemory, sizeof(SharedMemoryHeader))) {
+                    if (::munmap(m_sharedMemory, m_mappedSize)) {
 // clang-format off // LCOV_EXCL_LINE
                         std::cerr << "[cluon::SharedMemory (POSIX)] Failed to unmap shared memory: " << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
 // clang-format on // LCOV_EXCL_LINE
@@ -15330,10 +17806,19 @@ inline void SharedMemory::initPOSIX() noexcept {
                     m_sharedMemory = nullptr;
                     m_sharedMemoryHeader = nullptr;
 
+                    // Segments of writers with frame sequence numbers are exactly as long as to hold the frame synchronisation block.
+                    const std::size_t WITH_FRAME_SYNC{sizeof(SharedMemoryHeader) + frameSyncOffset(m_size) + sizeof(SharedMemoryFrameSync)};
+                    struct stat segmentStatus;
+                    const bool HAS_FRAME_SYNC{(0 == ::fstat(m_fd, &segmentStatus)) && (static_cast<std::size_t>(segmentStatus.st_size) == WITH_FRAME_SYNC)};
+                    m_mappedSize = HAS_FRAME_SYNC ? WITH_FRAME_SYNC : sizeof(SharedMemoryHeader) + m_size;
+
                     // Re-map with the correct size parameter.
-                    m_sharedMemory = static_cast<char *>(::mmap(0, sizeof(SharedMemoryHeader) + m_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0));
+                    m_sharedMemory = static_cast<char *>(::mmap(0, m_mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0));
                     if (MAP_FAILED != m_sharedMemory) {
                         m_sharedMemoryHeader = reinterpret_cast<SharedMemoryHeader *>(m_sharedMemory);
+                        if (HAS_FRAME_SYNC) {
+                            attachFrameSync(m_sharedMemory + sizeof(SharedMemoryHeader) + frameSyncOffset(m_size));
+                        }
                     }
                 }
             } else { // LCOV_EXCL_LINE
@@ -15347,7 +17832,7 @@ inline void SharedMemory::initPOSIX() noexcept {
                 m_userAccessibleSharedMemory = m_sharedMemory + sizeof(SharedMemoryHeader);
 
                 // Lock the shared memory into RAM for performance reasons.
-                if (-1 == ::mlock(m_sharedMemory, sizeof(SharedMemoryHeader) + m_size)) {
+                if (-1 == ::mlock(m_sharedMemory, m_mappedSize)) {
                     std::cerr << "[cluon::SharedMemory (POSIX)] Failed to mlock shared memory: " // LCOV_EXCL_LINE
                               << ::strerror(errno) << " (" << errno << ")" << std::endl;         // LCOV_EXCL_LINE
                 }
@@ -15390,7 +17875,7 @@ inline void SharedMemory::deinitPOSIX() noexcept {
         ::pthread_cond_destroy(&(m_sharedMemoryHeader->__condition));
         ::pthread_mutex_destroy(&(m_sharedMemoryHeader->__mutex));
     }
-    if ((nullptr != m_sharedMemory) && ::munmap(m_sharedMemory, sizeof(SharedMemoryHeader) + m_size)) {
+    if ((nullptr != m_sharedMemory) && ::munmap(m_sharedMemory, m_mappedSize)) {
 // clang-format off // LCOV_EXCL_LINE
         std::cerr << "[cluon::SharedMemory (POSIX)] Failed to unmap shared memory: " << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
 // clang-format on // LCOV_EXCL_LINE
@@ -15532,14 +18017,15 @@ inline void SharedMemory::initSysV() noexcept {
                     }
                 }
 
-                // Now, create the shared memory segment.
-                m_sharedMemoryIDSysV = ::shmget(m_shmKeySysV, m_size, IPC_CREAT | IPC_EXCL | S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH);
+                // Now, create the shared memory segment; the frame synchronisation block follows the user data.
+                m_sharedMemoryIDSysV = ::shmget(m_shmKeySysV, frameSyncOffset(m_size) + sizeof(SharedMemoryFrameSync), IPC_CREAT | IPC_EXCL | S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH);
                 if (-1 != m_sharedMemoryIDSysV) {
                     m_sharedMemory = reinterpret_cast<char *>(::shmat(m_sharedMemoryIDSysV, nullptr, 0));
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wold-style-cast"
                     if ((void *)-1 != m_sharedMemory) {
                         m_userAccessibleSharedMemory = m_sharedMemory;
+                        createFrameSync(m_sharedMemory + frameSyncOffset(m_size));
                     } else { // LCOV_EXCL_LINE
 // clang-format off // LCOV_EXCL_LINE
                         std::cerr << "[cluon::SharedMemory (SysV)] Failed to attach to shared memory (0x" << std::hex << m_shmKeySysV << std::dec << "): " << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
@@ -15563,6 +18049,15 @@ inline void SharedMemory::initSysV() noexcept {
 #pragma GCC diagnostic ignored "-Wold-style-cast"
                         if ((void *)-1 != m_sharedMemory) {
                             m_userAccessibleSharedMemory = m_sharedMemory;
+
+                            // Segments of writers with frame sequence numbers end with the frame synchronisation block.
+                            if ((sizeof(SharedMemoryFrameSync) <= m_size) && attachFrameSync(m_sharedMemory + m_size - sizeof(SharedMemoryFrameSync))) {
+                                if (frameSyncOffset(m_frameSync->__size) + sizeof(SharedMemoryFrameSync) == m_size) {
+                                    m_size = m_frameSync->__size;
+                                } else {
+                                    m_frameSync = nullptr;
+                                }
+                            }
                         } else { // LCOV_EXCL_LINE
 // clang-format off // LCOV_EXCL_LINE
                             std::cerr << "[cluon::SharedMemory (SysV)] Failed to attach to shared memory (0x" << std::hex << m_shmKeySysV << std::dec << "): " << ::strerror(errno) << " (" << errno << ")" << std::endl; // LCOV_EXCL_LINE
@@ -15843,6 +18338,65 @@ inline void SharedMemory::notifyAllSysV() noexcept {
 inline bool SharedMemory::validSysV() noexcept {
     return (-1 != m_sharedMemoryIDSysV) && (nullptr != m_sharedMemory) && (0 < m_size) && (-1 != m_mutexIDSysV) && (-1 != m_conditionIDSysV);
 }
+
+////////////////////////////////////////////////////////////////////////////////
+
+inline uint32_t SharedMemory::frameSyncOffset(uint32_t size) noexcept {
+    // Keep the 64-bit counters naturally aligned.
+    return (size + 7u) & ~7u;
+}
+
+inline void SharedMemory::createFrameSync(char *at) noexcept {
+    m_frameSync         = reinterpret_cast<SharedMemoryFrameSync *>(at);
+    m_frameSync->__size = m_size;
+    m_frameSync->__handshake.store(HANDSHAKE_OFF);
+    m_frameSync->__frameSequenceNumber.store(0);
+    m_frameSync->__frameDone.store(0);
+    m_frameSync->__magic = FRAME_SYNC_MAGIC;
+}
+
+inline bool SharedMemory::attachFrameSync(char *at) noexcept {
+    // Areas of older writers have user data here; only take the block if it is aligned and carries the magic number.
+    if (0 == (reinterpret_cast<uintptr_t>(at) % alignof(SharedMemoryFrameSync))) {
+        SharedMemoryFrameSync *frameSync = reinterpret_cast<SharedMemoryFrameSync *>(at);
+        if (FRAME_SYNC_MAGIC == frameSync->__magic) {
+            m_frameSync = frameSync;
+            // Frames notified before attaching are not skipped.
+            m_lastFrameSequenceNumber = m_frameSync->__frameSequenceNumber.load();
+        }
+    }
+    return (nullptr != m_frameSync);
+}
+
+inline void SharedMemory::waitForFrameDone() noexcept {
+    // Only the creating writer waits for the consumer in handshake mode; a consumer that
+    // has not finished a frame within a second is considered stalled and the handshake is
+    // suspended until the consumer marks a newer frame as done.
+    if ((nullptr == m_frameSync) || m_hasOnlyAttachedToSharedMemory) {
+        return;
+    }
+    uint32_t handshake{m_frameSync->__handshake.load()};
+    if ((HANDSHAKE_SUSPENDED == handshake) && (m_frameSync->__frameDone.load() > m_handshakeSuspendedAt)
+        && m_frameSync->__handshake.compare_exchange_strong(handshake, HANDSHAKE_ON)) {
+        std::cerr << "[cluon::SharedMemory] Consumer of '" << m_name << "' finished frame " << m_frameSync->__frameDone.load() << "; resuming handshake." << std::endl;
+        handshake = HANDSHAKE_ON;
+    }
+    if (HANDSHAKE_ON == handshake) {
+        const auto DEADLINE = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+        while (m_frameSync->__frameDone.load() < m_frameSync->__frameSequenceNumber.load()) {
+            if (std::chrono::steady_clock::now() >= DEADLINE) {
+                m_handshakeSuspendedAt = m_frameSync->__frameDone.load();
+                // The consumer might have disabled the handshake meanwhile.
+                if (m_frameSync->__handshake.compare_exchange_strong(handshake, HANDSHAKE_SUSPENDED)) {
+                    std::cerr << "[cluon::SharedMemory] Consumer did not finish frame " << m_frameSync->__frameSequenceNumber.load() << " of '" << m_name
+                              << "' within 1s; suspending handshake." << std::endl;
+                }
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+}
 #endif
 
 } // namespace cluon
@@ -17707,9 +20261,13 @@ int32_t main(int32_t argc, char **argv) {
 //#include "cluon/Player.hpp"
 //#include "cluon/cluonDataStructures.hpp"
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstdint>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -17720,10 +20278,13 @@ inline int32_t cluon_replay(int32_t argc, char **argv) {
     const std::string PROGRAM{argv[0]}; // NOLINT
     auto commandlineArguments = cluon::getCommandlineArguments(argc, argv);
     if (1 == argc) {
-        std::cerr << PROGRAM << " replays a .rec file into an OpenDaVINCI session or to stdout; if playing back to an OD4Session using parameter --cid, you can specify the optional parameter --stdout to also playback to stdout; --keeprunning keeps " << PROGRAM << " open at the end of a recording file." << std::endl;
-        std::cerr << "Usage:   " << PROGRAM << " [--cid=<OpenDaVINCI session> [--stdout] [--keeprunning]] recording.rec" << std::endl;
+        std::cerr << PROGRAM << " replays a .rec file into an OpenDaVINCI session or to stdout; if playing back to an OD4Session using parameter --cid, you can specify the optional parameter --stdout to also playback to stdout; --keeprunning keeps " << PROGRAM << " open at the end of a recording file; --filter replays only the listed messages (dataType or dataType/senderStamp), all other messages are skipped while indexing and never read; --speed scales the replay time (0 replays as fast as possible); --lockstep waits after every message listed in --lockstep-frames until the given acknowledgement message with the same sample time stamp was received in the OD4Session (optionally at most --lockstep-timeout milliseconds); acknowledgements for earlier frames are discarded." << std::endl;
+        std::cerr << "Usage:   " << PROGRAM << " [--cid=<OpenDaVINCI session> [--stdout] [--keeprunning]] [--filter=<ID[/senderStamp][,...]>] [--speed=<factor>] [--cid=<OpenDaVINCI session> --lockstep=<ID[/senderStamp]> --lockstep-frames=<ID[/senderStamp][,...]> [--lockstep-timeout=<ms>]] recording.rec" << std::endl;
         std::cerr << "Example: " << PROGRAM << " --cid=111 file.rec" << std::endl;
         std::cerr << "         " << PROGRAM << " --cid=111 --stdout file.rec" << std::endl;
+        std::cerr << "         " << PROGRAM << " --cid=111 --filter=1055,1086/0 file.rec" << std::endl;
+        std::cerr << "         " << PROGRAM << " --cid=111 --speed=10 file.rec" << std::endl;
+        std::cerr << "         " << PROGRAM << " --cid=111 --speed=0 --lockstep=1090/21 --lockstep-frames=1055 file.rec" << std::endl;
         std::cerr << "         " << PROGRAM << " file.rec" << std::endl;
         retCode = 1;
     }
@@ -17731,6 +20292,73 @@ inline int32_t cluon_replay(int32_t argc, char **argv) {
         const bool playBackToStdout = ( (0 != commandlineArguments.count("stdout")) || (0 == commandlineArguments.count("cid")) );
         const bool keepRunning = (0 != commandlineArguments.count("keeprunning"));
 
+        std::pair<bool, cluon::EnvelopeFilter> filter{true, cluon::EnvelopeFilter()};
+        if (0 != commandlineArguments.count("filter")) {
+            filter = cluon::EnvelopeFilter::fromString(commandlineArguments["filter"]);
+            if (!filter.first) {
+                std::cerr << PROGRAM << ": invalid --filter '" << commandlineArguments["filter"] << "'." << std::endl;
+                return 1;
+            }
+        }
+
+        // Factor to scale the replay time; 0 means as fast as possible.
+        double speed{1.0};
+        if (0 != commandlineArguments.count("speed")) {
+            try {
+                speed = std::stod(commandlineArguments["speed"]);
+            } catch (...) {
+                speed = -1.0;
+            }
+            if (!(speed >= 0.0)) {
+                std::cerr << PROGRAM << ": invalid --speed '" << commandlineArguments["speed"] << "'." << std::endl;
+                return 1;
+            }
+        }
+
+        // In lock-step mode, each frame is only followed by the next message
+        // once a downstream component has acknowledged it in the OD4Session.
+        const bool lockStep{0 != commandlineArguments.count("lockstep")};
+        int32_t ackDataType{0};
+        std::pair<bool, cluon::EnvelopeFilter> ack{true, cluon::EnvelopeFilter()};
+        std::pair<bool, cluon::EnvelopeFilter> lockStepFrames{true, cluon::EnvelopeFilter()};
+        uint32_t lockStepTimeout{0};
+        if (0 != commandlineArguments.count("lockstep-timeout")) {
+            const std::string TIMEOUT{commandlineArguments["lockstep-timeout"]};
+            int64_t timeout{-1};
+            try {
+                std::size_t parsed{0};
+                timeout = std::stoll(TIMEOUT, &parsed);
+                if (parsed != TIMEOUT.size()) {
+                    timeout = -1;
+                }
+            } catch (...) {
+                timeout = -1;
+            }
+            if ((timeout < 0) || (timeout > static_cast<int64_t>(std::numeric_limits<uint32_t>::max()))) {
+                std::cerr << PROGRAM << ": invalid --lockstep-timeout '" << TIMEOUT << "'." << std::endl;
+                return 1;
+            }
+            lockStepTimeout = static_cast<uint32_t>(timeout);
+        }
+        if (lockStep) {
+            ack            = cluon::EnvelopeFilter::fromString(commandlineArguments["lockstep"]);
+            lockStepFrames = cluon::EnvelopeFilter::fromString(commandlineArguments["lockstep-frames"]);
+            const std::string ACK{commandlineArguments["lockstep"]};
+            if (!ack.first || ack.second.acceptsAll() || (std::string::npos != ACK.find(','))) {
+                std::cerr << PROGRAM << ": invalid --lockstep '" << ACK << "'." << std::endl;
+                return 1;
+            }
+            if (!lockStepFrames.first || lockStepFrames.second.acceptsAll()) {
+                std::cerr << PROGRAM << ": --lockstep needs --lockstep-frames." << std::endl;
+                return 1;
+            }
+            if (0 == commandlineArguments.count("cid")) {
+                std::cerr << PROGRAM << ": --lockstep needs --cid." << std::endl;
+                return 1;
+            }
+            ackDataType = std::stoi(ACK.substr(0, ACK.find('/')));
+        }
+
         std::string recFile;
         for (auto e : commandlineArguments) {
             if (recFile.empty() && e.second.empty() && e.first != PROGRAM) {
@@ -17745,6 +20373,15 @@ inline int32_t cluon_replay(int32_t argc, char **argv) {
             std::mutex playerCommandMutex;
             cluon::data::PlayerCommand playerCommand;
 
+            // Acknowledgements received in lock-step mode; an acknowledgement belongs to the frame
+            // with the same sample time stamp, all others are late ones for earlier frames.
+            std::mutex ackMutex;
+            std::condition_variable ackCondition;
+            bool awaitingAck{false};
+            int64_t awaitedAck{0};
+            bool ackReceived{false};
+            uint64_t lateAcks{0};
+
             // Create an OD4Session to relay the.
             std::unique_ptr<cluon::OD4Session> od4;
             if (0 != commandlineArguments.count("cid")) {
@@ -17759,6 +20396,23 @@ inline int32_t cluon_replay(int32_t argc, char **argv) {
                         }
                         playCommandUpdate = true;
                     });
+                    if (lockStep) {
+                        const cluon::EnvelopeFilter &ACK{ack.second};
+                        od4->dataTrigger(ackDataType, [&ACK, &ackMutex, &ackCondition, &awaitingAck, &awaitedAck, &ackReceived, &lateAcks](cluon::data::Envelope &&env){
+                            if (ACK.accepts(env.dataType(), env.senderStamp())) {
+                                const int64_t SAMPLE_TIME{cluon::time::toMicroseconds(env.sampleTimeStamp())};
+                                {
+                                    std::lock_guard<std::mutex> lck(ackMutex);
+                                    if (awaitingAck && (awaitedAck == SAMPLE_TIME)) {
+                                        ackReceived = true;
+                                    } else {
+                                        lateAcks++;
+                                    }
+                                }
+                                ackCondition.notify_all();
+                            }
+                        });
+                    }
                 }
             }
 
@@ -17792,7 +20446,7 @@ inline int32_t cluon_replay(int32_t argc, char **argv) {
             }
             constexpr bool AUTOREWIND{false};
             constexpr bool THREADING{true};
-            cluon::Player player(recFile, AUTOREWIND, THREADING);
+            cluon::Player player(recFile, AUTOREWIND, THREADING, filter.second);
             player.setPlayerListener([&playerStatusUpdate, &playerStatusMutex, &playerStatus](cluon::data::PlayerStatus &&ps){
                 {
                     std::lock_guard<std::mutex> lck(playerStatusMutex);
@@ -17829,6 +20483,9 @@ inline int32_t cluon_replay(int32_t argc, char **argv) {
 
             bool play = true;
             bool step = false;
+            // Point in time when the next message is due; advanced by the scaled delays
+            // instead of sleeping after each message so that the processing time does not add up.
+            std::chrono::steady_clock::time_point nextDue{std::chrono::steady_clock::now()};
             while ( (player.hasMoreData() || keepRunning) ) {
                 // Stop execution in case of a running OD4Session.
                 if (od4 && !od4->isRunning()) {
@@ -17890,6 +20547,13 @@ inline int32_t cluon_replay(int32_t argc, char **argv) {
                 if (play || step) {
                     auto next = player.getNextEnvelopeToBeReplayed();
                     if (next.first) {
+                        const bool waitForAck{lockStep && lockStepFrames.second.accepts(next.second.dataType(), next.second.senderStamp())};
+                        if (waitForAck) {
+                            std::lock_guard<std::mutex> lck(ackMutex);
+                            awaitingAck = true;
+                            awaitedAck  = cluon::time::toMicroseconds(next.second.sampleTimeStamp());
+                            ackReceived = false;
+                        }
                         if (od4 && od4->isRunning()) {
                             cluon::data::Envelope e = next.second;
                             od4->send(std::move(e));
@@ -17899,11 +20563,41 @@ inline int32_t cluon_replay(int32_t argc, char **argv) {
                             std::cout << cluon::serializeEnvelope(std::move(e));
                             std::cout.flush();
                         }
-                        std::this_thread::sleep_for(std::chrono::duration<int32_t, std::micro>(player.delay()));
+                        if (waitForAck) {
+                            // Wait in slices to notice a stopped OD4Session.
+                            const auto START{std::chrono::steady_clock::now()};
+                            std::unique_lock<std::mutex> lck(ackMutex);
+                            while (!ackReceived && od4->isRunning()) {
+                                ackCondition.wait_for(lck, std::chrono::milliseconds(100));
+                                if ((0 < lockStepTimeout) && !ackReceived
+                                    && (std::chrono::steady_clock::now() - START >= std::chrono::milliseconds(lockStepTimeout))) {
+                                    std::clog << PROGRAM << ": No acknowledgement within " << lockStepTimeout << "ms; continuing." << std::endl;
+                                    break;
+                                }
+                            }
+                            awaitingAck = false;
+                            if (0 < lateAcks) {
+                                // A late acknowledgement must not release the next frame.
+                                std::clog << PROGRAM << ": Discarded " << lateAcks << " acknowledgement(s) for earlier frames." << std::endl;
+                                lateAcks = 0;
+                            }
+                        }
+                        if (0.0 < speed) {
+                            nextDue += std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double, std::micro>(player.delay() / speed));
+                            const auto NOW{std::chrono::steady_clock::now()};
+                            if (nextDue > NOW) {
+                                std::this_thread::sleep_until(nextDue);
+                            }
+                            else {
+                                // Do not try to catch up when falling behind.
+                                nextDue = NOW;
+                            }
+                        }
                     }
                 }
                 else {
                     std::this_thread::sleep_for(std::chrono::duration<int32_t, std::milli>(100)); // LCOV_EXCL_LINE
+                    nextDue = std::chrono::steady_clock::now(); // LCOV_EXCL_LINE
                 } // LCOV_EXCL_LINE
 
                 // Reset step.
@@ -0,0 +1,75 @@
+/* Title: Cone Detection - locating the largest cone of a colour in a binary mask
+ * Authors: Nasit Vurgun, Sam Hardingham, Kai Rowley, Daniel van den Heuvel
+ * Institution: University of Gothenburg, Sweden
+ * Course: DIT638/DIT639 (2024), taught by Prof. Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CONE_DETECTION_HPP
+#define CONE_DETECTION_HPP
+
+#include <opencv2/core/core.hpp>
+
+#include "blob-detector.hpp"
+
+#include <cstddef> // For std::size_t
+
+// Minimum bounding rect area (in pixels) for a region to count as a cone.
+const int DETECTION_THRESHOLD = 10;
+
+// Finds the region with the largest bounding rect in mask; this is the same rect the former
+// findContours(RETR_TREE) + boundingRect() scan selected. Returns false if the mask is empty.
+inline bool findLargestCone(BlobDetector &detector, const cv::Mat &mask, cv::Rect &largest)
+{
+    detector.detect(mask);
+    if (0 == detector.topK(1))
+    {
+        return false;
+    }
+    largest = detector.blobs().front().rect;
+    return true;
+}
+
+// Search for the largest cones of one colour; each colour is an independent job.
+struct ConeSearch
+{
+    cv::Mat *mask;
+    BlobDetector detector;
+    std::size_t cones; // number of cones at the front of detector.blobs(), largest first
+
+    // Finds up to maxCones cones in the mask.
+    void run(std::size_t maxCones)
+    {
+        detector.detect(*mask);
+        cones = detector.topK(maxCones);
+    }
+
+    const Blob &largest() const
+    {
+        return detector.blobs().front();
+    }
+};
+
+// Midpoint of a cone's bounding rect, or (-1, -1) if its area is below the detection threshold.
+inline cv::Point coneMidpoint(const cv::Rect &boundingRect, int detection_threshold)
+{
+    if (boundingRect.width * boundingRect.height > detection_threshold)
+    {
+        return cv::Point(boundingRect.x + boundingRect.width / 2, boundingRect.y + boundingRect.height / 2);
+    }
+    return cv::Point(-1, -1);
+}
+
+#endif
@@ -0,0 +1,412 @@
+/* Title: Cone Mask - fused BGR(A) -> HSV -> dual-range threshold kernel
+ * Authors: Nasit Vurgun, Sam Hardingham, Kai Rowley, Daniel van den Heuvel
+ * Institution: University of Gothenburg, Sweden
+ * Course: DIT638/DIT639 (2024), taught by Prof. Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CONE_MASK_HPP
+#define CONE_MASK_HPP
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include <cmath>   // For std::lround
+#include <cstdint> // For fixed width integers
+#include <cstring> // For std::memcpy
+
+// clang-format off
+#if defined(__x86_64__) || defined(__i386__)
+    #include <immintrin.h>
+    #define CONE_MASK_X86
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+    #include <arm_neon.h>
+    #define CONE_MASK_NEON
+#endif
+// clang-format on
+
+// The kernel reads every BGRA pixel of the ROI once and writes the yellow and the blue mask
+// directly, without materialising an HSV image in between. The HSV values are computed
+// bit-exactly like cv::cvtColor(..., COLOR_BGR2HSV) for 8-bit images (fixed point with 12
+// fractional bits and the same rounded reciprocal tables), so the masks are identical to
+// cvtColor() followed by two cv::inRange() calls.
+//
+// The SIMD variants compute the table entries on the fly as round(constant / x) in single
+// precision, which yields the same integers as the double-precision tables for all x in [1, 255].
+
+namespace conemask
+{
+const int HSV_SHIFT = 12;
+const int32_t HSV_HALF = 1 << (HSV_SHIFT - 1);
+// Numerators of the reciprocal tables: sdiv[v] = round(S_NUMERATOR / v), hdiv[d] = round(H_NUMERATOR / d).
+const int32_t S_NUMERATOR = 255 << HSV_SHIFT;
+const int32_t H_NUMERATOR = (180 << HSV_SHIFT) / 6;
+
+// Inclusive HSV bounds of one colour range as used by cv::inRange on 8-bit images.
+struct HsvBounds
+{
+    int32_t lo[3];
+    int32_t hi[3];
+};
+
+inline int32_t saturateToByte(double value)
+{
+    long rounded = std::lround(value);
+    return static_cast<int32_t>((rounded < 0) ? 0 : ((rounded > 255) ? 255 : rounded));
+}
+
+inline HsvBounds toBounds(const cv::Scalar &min, const cv::Scalar &max)
+{
+    HsvBounds bounds;
+    for (int i = 0; i < 3; i++)
+    {
+        bounds.lo[i] = saturateToByte(min[i]);
+        bounds.hi[i] = saturateToByte(max[i]);
+    }
+    return bounds;
+}
+
+// Reciprocal tables as built by OpenCV's RGB2HSV_b.
+struct HsvTables
+{
+    int32_t sdiv[256];
+    int32_t hdiv[256];
+
+    HsvTables()
+        : sdiv(), hdiv()
+    {
+        for (int i = 1; i < 256; i++)
+        {
+            sdiv[i] = static_cast<int32_t>(std::lround(S_NUMERATOR / (1.0 * i)));
+            hdiv[i] = static_cast<int32_t>(std::lround((180 << HSV_SHIFT) / (6.0 * i)));
+        }
+    }
+};
+
+inline const HsvTables &hsvTables()
+{
+    static const HsvTables tables;
+    return tables;
+}
+
+inline bool inBounds(int32_t h, int32_t s, int32_t v, const HsvBounds &bounds)
+{
+    return (h >= bounds.lo[0]) && (h <= bounds.hi[0]) &&
+           (s >= bounds.lo[1]) && (s <= bounds.hi[1]) &&
+           (v >= bounds.lo[2]) && (v <= bounds.hi[2]);
+}
+
+// Scalar reference; also used for the remaining pixels of a row after the SIMD loop.
+inline void masksScalar(const uint8_t *src, int count, const HsvBounds &a, const HsvBounds &b, uint8_t *maskA, uint8_t *maskB)
+{
+    const HsvTables &tables = hsvTables();
+    for (int i = 0; i < count; i++, src += 4)
+    {
+        const int32_t blue = src[0], green = src[1], red = src[2];
+        int32_t v = blue > green ? blue : green;
+        v = v > red ? v : red;
+        int32_t vmin = blue < green ? blue : green;
+        vmin = vmin < red ? vmin : red;
+        const int32_t diff = v - vmin;
+        const int32_t vr = (v == red) ? -1 : 0;
+        const int32_t vg = (v == green) ? -1 : 0;
+
+        const int32_t s = (diff * tables.sdiv[v] + HSV_HALF) >> HSV_SHIFT;
+        int32_t h = (vr & (green - blue)) + (~vr & ((vg & (blue - red + 2 * diff)) + ((~vg) & (red - green + 4 * diff))));
+        h = (h * tables.hdiv[diff] + HSV_HALF) >> HSV_SHIFT;
+        h += (h < 0) ? 180 : 0;
+
+        maskA[i] = inBounds(h, s, v, a) ? 255 : 0;
+        maskB[i] = inBounds(h, s, v, b) ? 255 : 0;
+    }
+}
+
+// clang-format off
+#if defined(__GNUC__) && !defined(__clang__)
+    // The body is always inlined into a function compiled for the matching instruction set,
+    // so the note about passing AVX vectors without AVX enabled does not apply.
+    #pragma GCC diagnostic push
+    #pragma GCC diagnostic ignored "-Wpsabi"
+#endif
+// clang-format on
+
+// Generic SIMD body; Ops wraps the instructions of one instruction set and processes
+// Ops::LANES pixels per iteration in 32-bit lanes. Returns the number of pixels processed.
+template <typename Ops>
+inline __attribute__((always_inline)) int masksSimd(const uint8_t *src, int count, const HsvBounds &a, const HsvBounds &b, uint8_t *maskA, uint8_t *maskB)
+{
+    typedef typename Ops::V V;
+    const V one = Ops::set1(1);
+    const V half = Ops::set1(HSV_HALF);
+    const V hueRange = Ops::set1(180);
+    const V zero = Ops::set1(0);
+
+    // Bounds are compared with ">" only: x >= lo <=> x > lo - 1 and x <= hi <=> hi + 1 > x.
+    V aLo[3], aHi[3], bLo[3], bHi[3];
+    for (int c = 0; c < 3; c++)
+    {
+        aLo[c] = Ops::set1(a.lo[c] - 1);
+        aHi[c] = Ops::set1(a.hi[c] + 1);
+        bLo[c] = Ops::set1(b.lo[c] - 1);
+        bHi[c] = Ops::set1(b.hi[c] + 1);
+    }
+
+    int i = 0;
+    for (; i + Ops::LANES <= count; i += Ops::LANES)
+    {
+        const V px = Ops::load(src + 4 * i);
+        const V blue = Ops::channel(px, 0);
+        const V green = Ops::channel(px, 8);
+        const V red = Ops::channel(px, 16);
+
+        const V v = Ops::max(Ops::max(blue, green), red);
+        const V vmin = Ops::min(Ops::min(blue, green), red);
+        const V diff = Ops::sub(v, vmin);
+        const V vr = Ops::cmpeq(v, red);
+        const V vg = Ops::cmpeq(v, green);
+        const V diff2 = Ops::add(diff, diff);
+
+        const V s = Ops::shift(Ops::add(Ops::mul(diff, Ops::reciprocal(S_NUMERATOR, Ops::max(v, one))), half));
+
+        const V hr = Ops::sub(green, blue);
+        const V hg = Ops::add(Ops::sub(blue, red), diff2);
+        const V hb = Ops::add(Ops::sub(red, green), Ops::add(diff2, diff2));
+        V h = Ops::bitOr(Ops::bitAnd(vr, hr), Ops::andNot(vr, Ops::bitOr(Ops::bitAnd(vg, hg), Ops::andNot(vg, hb))));
+        h = Ops::shift(Ops::add(Ops::mul(h, Ops::reciprocal(H_NUMERATOR, Ops::max(diff, one))), half));
+        h = Ops::add(h, Ops::bitAnd(Ops::cmpgt(zero, h), hueRange));
+
+        const V inA = Ops::bitAnd(Ops::bitAnd(Ops::bitAnd(Ops::cmpgt(h, aLo[0]), Ops::cmpgt(aHi[0], h)),
+                                              Ops::bitAnd(Ops::cmpgt(s, aLo[1]), Ops::cmpgt(aHi[1], s))),
+                                  Ops::bitAnd(Ops::cmpgt(v, aLo[2]), Ops::cmpgt(aHi[2], v)));
+        const V inB = Ops::bitAnd(Ops::bitAnd(Ops::bitAnd(Ops::cmpgt(h, bLo[0]), Ops::cmpgt(bHi[0], h)),
+                                              Ops::bitAnd(Ops::cmpgt(s, bLo[1]), Ops::cmpgt(bHi[1], s))),
+                                  Ops::bitAnd(Ops::cmpgt(v, bLo[2]), Ops::cmpgt(bHi[2], v)));
+        Ops::storeMask(maskA + i, inA);
+        Ops::storeMask(maskB + i, inB);
+    }
+    return i;
+}
+
+// clang-format off
+#if defined(__GNUC__) && !defined(__clang__)
+    #pragma GCC diagnostic pop
+#endif
+// clang-format on
+
+#ifdef CONE_MASK_X86
+#define CONE_MASK_TARGET(isa) __attribute__((target(isa)))
+
+struct Sse41Ops
+{
+    typedef __m128i V;
+    static const int LANES = 4;
+    CONE_MASK_TARGET("sse4.1") static inline V load(const uint8_t *p) { return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)); }
+    CONE_MASK_TARGET("sse4.1") static inline V set1(int32_t x) { return _mm_set1_epi32(x); }
+    CONE_MASK_TARGET("sse4.1") static inline V channel(V px, int shift) { return _mm_and_si128(_mm_srl_epi32(px, _mm_cvtsi32_si128(shift)), _mm_set1_epi32(0xFF)); }
+    CONE_MASK_TARGET("sse4.1") static inline V max(V x, V y) { return _mm_max_epi32(x, y); }
+    CONE_MASK_TARGET("sse4.1") static inline V min(V x, V y) { return _mm_min_epi32(x, y); }
+    CONE_MASK_TARGET("sse4.1") static inline V add(V x, V y) { return _mm_add_epi32(x, y); }
+    CONE_MASK_TARGET("sse4.1") static inline V sub(V x, V y) { return _mm_sub_epi32(x, y); }
+    CONE_MASK_TARGET("sse4.1") static inline V mul(V x, V y) { return _mm_mullo_epi32(x, y); }
+    CONE_MASK_TARGET("sse4.1") static inline V shift(V x) { return _mm_srai_epi32(x, HSV_SHIFT); }
+    CONE_MASK_TARGET("sse4.1") static inline V cmpeq(V x, V y) { return _mm_cmpeq_epi32(x, y); }
+    CONE_MASK_TARGET("sse4.1") static inline V cmpgt(V x, V y) { return _mm_cmpgt_epi32(x, y); }
+    CONE_MASK_TARGET("sse4.1") static inline V bitAnd(V x, V y) { return _mm_and_si128(x, y); }
+    CONE_MASK_TARGET("sse4.1") static inline V bitOr(V x, V y) { return _mm_or_si128(x, y); }
+    CONE_MASK_TARGET("sse4.1") static inline V andNot(V x, V y) { return _mm_andnot_si128(x, y); }
+    CONE_MASK_TARGET("sse4.1") static inline V reciprocal(int32_t numerator, V x)
+    {
+        return _mm_cvtps_epi32(_mm_div_ps(_mm_set1_ps(static_cast<float>(numerator)), _mm_cvtepi32_ps(x)));
+    }
+    CONE_MASK_TARGET("sse4.1") static inline void storeMask(uint8_t *dst, V m)
+    {
+        const V packed = _mm_packs_epi16(_mm_packs_epi32(m, m), m);
+        const int32_t bytes = _mm_cvtsi128_si32(packed);
+        std::memcpy(dst, &bytes, sizeof(bytes));
+    }
+};
+
+struct Avx2Ops
+{
+    typedef __m256i V;
+    static const int LANES = 8;
+    CONE_MASK_TARGET("avx2") static inline V load(const uint8_t *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+    CONE_MASK_TARGET("avx2") static inline V set1(int32_t x) { return _mm256_set1_epi32(x); }
+    CONE_MASK_TARGET("avx2") static inline V channel(V px, int shift) { return _mm256_and_si256(_mm256_srl_epi32(px, _mm_cvtsi32_si128(shift)), _mm256_set1_epi32(0xFF)); }
+    CONE_MASK_TARGET("avx2") static inline V max(V x, V y) { return _mm256_max_epi32(x, y); }
+    CONE_MASK_TARGET("avx2") static inline V min(V x, V y) { return _mm256_min_epi32(x, y); }
+    CONE_MASK_TARGET("avx2") static inline V add(V x, V y) { return _mm256_add_epi32(x, y); }
+    CONE_MASK_TARGET("avx2") static inline V sub(V x, V y) { return _mm256_sub_epi32(x, y); }
+    CONE_MASK_TARGET("avx2") static inline V mul(V x, V y) { return _mm256_mullo_epi32(x, y); }
+    CONE_MASK_TARGET("avx2") static inline V shift(V x) { return _mm256_srai_epi32(x, HSV_SHIFT); }
+    CONE_MASK_TARGET("avx2") static inline V cmpeq(V x, V y) { return _mm256_cmpeq_epi32(x, y); }
+    CONE_MASK_TARGET("avx2") static inline V cmpgt(V x, V y) { return _mm256_cmpgt_epi32(x, y); }
+    CONE_MASK_TARGET("avx2") static inline V bitAnd(V x, V y) { return _mm256_and_si256(x, y); }
+    CONE_MASK_TARGET("avx2") static inline V bitOr(V x, V y) { return _mm256_or_si256(x, y); }
+    CONE_MASK_TARGET("avx2") static inline V andNot(V x, V y) { return _mm256_andnot_si256(x, y); }
+    CONE_MASK_TARGET("avx2") static inline V reciprocal(int32_t numerator, V x)
+    {
+        return _mm256_cvtps_epi32(_mm256_div_ps(_mm256_set1_ps(static_cast<float>(numerator)), _mm256_cvtepi32_ps(x)));
+    }
+    CONE_MASK_TARGET("avx2") static inline void storeMask(uint8_t *dst, V m)
+    {
+        const __m128i words = _mm_packs_epi32(_mm256_castsi256_si128(m), _mm256_extracti128_si256(m, 1));
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(dst), _mm_packs_epi16(words, words));
+    }
+};
+
+CONE_MASK_TARGET("sse4.1") inline int masksSse41(const uint8_t *src, int count, const HsvBounds &a, const HsvBounds &b, uint8_t *maskA, uint8_t *maskB)
+{
+    return masksSimd<Sse41Ops>(src, count, a, b, maskA, maskB);
+}
+
+CONE_MASK_TARGET("avx2") inline int masksAvx2(const uint8_t *src, int count, const HsvBounds &a, const HsvBounds &b, uint8_t *maskA, uint8_t *maskB)
+{
+    return masksSimd<Avx2Ops>(src, count, a, b, maskA, maskB);
+}
+#undef CONE_MASK_TARGET
+#endif
+
+#ifdef CONE_MASK_NEON
+struct NeonOps
+{
+    typedef int32x4_t V;
+    static const int LANES = 4;
+    static inline V load(const uint8_t *p) { return vreinterpretq_s32_u8(vld1q_u8(p)); }
+    static inline V set1(int32_t x) { return vdupq_n_s32(x); }
+    static inline V channel(V px, int shift) { return vandq_s32(vreinterpretq_s32_u32(vshlq_u32(vreinterpretq_u32_s32(px), vdupq_n_s32(-shift))), vdupq_n_s32(0xFF)); }
+    static inline V max(V x, V y) { return vmaxq_s32(x, y); }
+    static inline V min(V x, V y) { return vminq_s32(x, y); }
+    static inline V add(V x, V y) { return vaddq_s32(x, y); }
+    static inline V sub(V x, V y) { return vsubq_s32(x, y); }
+    static inline V mul(V x, V y) { return vmulq_s32(x, y); }
+    static inline V shift(V x) { return vshrq_n_s32(x, HSV_SHIFT); }
+    static inline V cmpeq(V x, V y) { return vreinterpretq_s32_u32(vceqq_s32(x, y)); }
+    static inline V cmpgt(V x, V y) { return vreinterpretq_s32_u32(vcgtq_s32(x, y)); }
+    static inline V bitAnd(V x, V y) { return vandq_s32(x, y); }
+    static inline V bitOr(V x, V y) { return vorrq_s32(x, y); }
+    static inline V andNot(V x, V y) { return vbicq_s32(y, x); }
+    static inline V reciprocal(int32_t numerator, V x)
+    {
+        return vcvtnq_s32_f32(vdivq_f32(vdupq_n_f32(static_cast<float>(numerator)), vcvtq_f32_s32(x)));
+    }
+    static inline void storeMask(uint8_t *dst, V m)
+    {
+        const uint16x4_t words = vmovn_u32(vreinterpretq_u32_s32(m));
+        const uint8x8_t bytes = vmovn_u16(vcombine_u16(words, words));
+        vst1_lane_u32(reinterpret_cast<uint32_t *>(dst), vreinterpret_u32_u8(bytes), 0);
+    }
+};
+#endif
+
+// Instruction set used by fusedConeMasks() on this machine.
+enum class Isa
+{
+    SCALAR,
+    SSE41,
+    AVX2,
+    NEON
+};
+
+inline Isa detectIsa()
+{
+#if defined(CONE_MASK_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return Isa::AVX2;
+    }
+    if (__builtin_cpu_supports("sse4.1"))
+    {
+        return Isa::SSE41;
+    }
+    return Isa::SCALAR;
+#elif defined(CONE_MASK_NEON)
+    return Isa::NEON;
+#else
+    return Isa::SCALAR;
+#endif
+}
+
+inline const char *isaName(Isa isa)
+{
+    switch (isa)
+    {
+    case Isa::SSE41:
+        return "sse4.1";
+    case Isa::AVX2:
+        return "avx2";
+    case Isa::NEON:
+        return "neon";
+    case Isa::SCALAR:
+        break;
+    }
+    return "scalar";
+}
+
+// Fused kernel for count BGRA pixels using the given instruction set.
+inline void masksRow(Isa isa, const uint8_t *src, int count, const HsvBounds &a, const HsvBounds &b, uint8_t *maskA, uint8_t *maskB)
+{
+    int done = 0;
+    switch (isa)
+    {
+#ifdef CONE_MASK_X86
+    case Isa::AVX2:
+        done = masksAvx2(src, count, a, b, maskA, maskB);
+        break;
+    case Isa::SSE41:
+        done = masksSse41(src, count, a, b, maskA, maskB);
+        break;
+#endif
+#ifdef CONE_MASK_NEON
+    case Isa::NEON:
+        done = masksSimd<NeonOps>(src, count, a, b, maskA, maskB);
+        break;
+#endif
+    default:
+        break;
+    }
+    masksScalar(src + 4 * done, count - done, a, b, maskA + done, maskB + done);
+}
+} // namespace conemask
+
+// Computes the masks of two HSV ranges for a BGR(A) image in a single pass, equivalent to
+// cv::cvtColor(src, hsv, COLOR_BGR2HSV) followed by cv::inRange() for each range.
+// maskA and maskB are (re)allocated as CV_8UC1 only if their size does not match.
+inline void fusedConeMasks(const cv::Mat &src, const cv::Scalar &minA, const cv::Scalar &maxA, const cv::Scalar &minB, const cv::Scalar &maxB, cv::Mat &maskA, cv::Mat &maskB)
+{
+    maskA.create(src.rows, src.cols, CV_8UC1);
+    maskB.create(src.rows, src.cols, CV_8UC1);
+
+    // Only 4-channel images are handled by the fused kernel (that is what the shared memory delivers).
+    if (CV_8UC4 != src.type())
+    {
+        cv::Mat hsv;
+        cv::cvtColor(src, hsv, cv::COLOR_BGR2HSV);
+        cv::inRange(hsv, minA, maxA, maskA);
+        cv::inRange(hsv, minB, maxB, maskB);
+        return;
+    }
+
+    static const conemask::Isa isa = conemask::detectIsa();
+    const conemask::HsvBounds a = conemask::toBounds(minA, maxA);
+    const conemask::HsvBounds b = conemask::toBounds(minB, maxB);
+    for (int row = 0; row < src.rows; row++)
+    {
+        conemask::masksRow(isa, src.ptr<uint8_t>(row), src.cols, a, b, maskA.ptr<uint8_t>(row), maskB.ptr<uint8_t>(row));
+    }
+}
+
+#endif
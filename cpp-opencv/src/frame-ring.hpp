@@ -0,0 +1,138 @@
+/* Title: Frame Ring - pre-allocated ROI snapshots of the shared memory image
+ * Authors: Nasit Vurgun, Sam Hardingham, Kai Rowley, Daniel van den Heuvel
+ * Institution: University of Gothenburg, Sweden
+ * Course: DIT638/DIT639 (2024), taught by Prof. Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FRAME_RING_HPP
+#define FRAME_RING_HPP
+
+#include <opencv2/core/core.hpp>
+
+#include <chrono>  // For measuring lock-hold time
+#include <cstddef> // For std::size_t
+#include <cstdint> // For fixed width integers
+#include <vector>  // For the buffer storage
+
+// Ring of image buffers that receive a copy of the region of interest of every frame.
+// All buffers are allocated once in the constructor and reused afterwards, so taking a
+// snapshot while the shared memory is locked is a plain row-by-row memcpy without any
+// allocation. With two or more slots, the previously stored frame stays valid while the
+// next one is copied in (double buffering).
+class FrameRing
+{
+public:
+    FrameRing(std::size_t slots, const cv::Size &size, int type)
+        : m_buffers(slots < 1 ? 1 : slots)
+    {
+        for (auto &buffer : m_buffers)
+        {
+            buffer.create(size, type);
+        }
+    }
+
+    // Copies the ROI of source into the next slot; source must match size and type of the slots.
+    cv::Mat &store(const cv::Mat &source, const cv::Rect &roi)
+    {
+        m_current = (m_current + 1) % m_buffers.size();
+        cv::Mat &slot = m_buffers[m_current];
+        // copyTo() reuses the destination as its size and type already match.
+        source(roi).copyTo(slot);
+        return slot;
+    }
+
+    // Most recently stored snapshot.
+    cv::Mat &latest()
+    {
+        return m_buffers[m_current];
+    }
+
+    std::size_t slots() const
+    {
+        return m_buffers.size();
+    }
+
+private:
+    std::vector<cv::Mat> m_buffers;
+    std::size_t m_current{0};
+};
+
+// Keeps track of how long the frame loop waited for the shared memory lock and how long it held
+// it per frame (in microseconds). Waiting depends on the producer; holding it is what the frame loop
+// costs the producer, so both are reported separately.
+class LockHoldTimer
+{
+public:
+    // Call directly before SharedMemory::lock().
+    void start()
+    {
+        m_start = std::chrono::steady_clock::now();
+        m_acquired = m_start;
+    }
+
+    // Call directly after SharedMemory::lock() has returned (e.g. first thing in the copy callback);
+    // when called again for a retried copy, the earlier attempts count as waiting.
+    void acquired()
+    {
+        m_acquired = std::chrono::steady_clock::now();
+    }
+
+    // Call directly after SharedMemory::unlock(); returns the lock-hold time of this frame.
+    int64_t stop()
+    {
+        const std::chrono::steady_clock::time_point NOW{std::chrono::steady_clock::now()};
+        m_wait.add(std::chrono::duration_cast<std::chrono::microseconds>(m_acquired - m_start).count());
+        m_hold.add(std::chrono::duration_cast<std::chrono::microseconds>(NOW - m_acquired).count());
+        return m_hold.last;
+    }
+
+    int64_t last() const { return m_hold.last; }
+    int64_t max() const { return m_hold.max; }
+    double mean() const { return m_hold.mean(); }
+
+    int64_t lastWait() const { return m_wait.last; }
+    int64_t maxWait() const { return m_wait.max; }
+    double meanWait() const { return m_wait.mean(); }
+
+private:
+    struct Durations
+    {
+        int64_t last{0};
+        int64_t max{0};
+        int64_t total{0};
+        int64_t frames{0};
+
+        void add(int64_t duration)
+        {
+            last = duration;
+            total += duration;
+            frames++;
+            if (duration > max)
+            {
+                max = duration;
+            }
+        }
+
+        double mean() const { return (frames > 0) ? static_cast<double>(total) / static_cast<double>(frames) : 0.0; }
+    };
+
+    std::chrono::steady_clock::time_point m_start{};
+    std::chrono::steady_clock::time_point m_acquired{};
+    Durations m_wait{};
+    Durations m_hold{};
+};
+
+#endif
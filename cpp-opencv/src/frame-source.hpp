@@ -0,0 +1,201 @@
+/* Title: Frame Source - the frames of the producer from a frame ring or the single-slot shared memory
+ * Authors: Nasit Vurgun, Sam Hardingham, Kai Rowley, Daniel van den Heuvel
+ * Institution: University of Gothenburg, Sweden
+ * Course: DIT638/DIT639 (2024), taught by Prof. Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FRAME_SOURCE_HPP
+#define FRAME_SOURCE_HPP
+
+#include "cluon-complete.hpp"
+
+#include <chrono>  // For the wait timeout
+#include <cstdint> // For fixed width integers
+#include <memory>  // For the transports
+#include <string>  // For the name
+#include <utility> // For std::pair
+
+// Attaches to the frames of a producer by name: to its cluon::SharedMemoryRing if it writes one
+// (no shared lock; the newest complete frame is taken), otherwise to its cluon::SharedMemory
+// (a single slot under a process-shared lock). A ring left behind by a producer that is gone
+// is recognized by its sequence number not advancing within activityTimeout; then, a valid
+// SharedMemory of the same name is taken instead.
+class FrameSource
+{
+private:
+    FrameSource(const FrameSource &) = delete;
+    FrameSource(FrameSource &&) = delete;
+    FrameSource &operator=(const FrameSource &) = delete;
+    FrameSource &operator=(FrameSource &&) = delete;
+
+public:
+    explicit FrameSource(const std::string &name, const std::chrono::milliseconds &activityTimeout = std::chrono::milliseconds(1000))
+        : m_ring(new cluon::SharedMemoryRing{name}), m_sharedMemory()
+    {
+        if (m_ring->valid() && !m_ring->waitForFrame(m_ring->frameSequenceNumber(), activityTimeout))
+        {
+            // No frame within the timeout: the ring may be stale, so prefer a SharedMemory that exists.
+            std::unique_ptr<cluon::SharedMemory> sharedMemory{new cluon::SharedMemory{name}};
+            if (sharedMemory->valid())
+            {
+                m_ring.reset();
+                m_sharedMemory = std::move(sharedMemory);
+                m_idleRingSkipped = true;
+            }
+        }
+        if (m_ring && !m_ring->valid())
+        {
+            m_ring.reset();
+            m_sharedMemory.reset(new cluon::SharedMemory{name});
+        }
+        // Like SharedMemory::wait(), start with the next frame that is written.
+        m_frameSequenceNumber = m_ring ? m_ring->frameSequenceNumber() : m_sharedMemory->frameSequenceNumber();
+    }
+
+    bool valid() const
+    {
+        return m_ring ? m_ring->valid() : (m_sharedMemory && m_sharedMemory->valid());
+    }
+
+    bool isRing() const
+    {
+        return static_cast<bool>(m_ring);
+    }
+
+    // True if a frame ring of this name exists but was skipped as no frame was written to it.
+    bool idleRingSkipped() const
+    {
+        return m_idleRingSkipped;
+    }
+
+    std::string name() const
+    {
+        return m_ring ? m_ring->name() : m_sharedMemory->name();
+    }
+
+    uint32_t size() const
+    {
+        return m_ring ? m_ring->size() : m_sharedMemory->size();
+    }
+
+    bool hasFrameSequenceNumbers() const
+    {
+        return m_ring || m_sharedMemory->hasFrameSequenceNumbers();
+    }
+
+    // Lock-step with the producer; only the single-slot shared memory can make its writer wait.
+    bool setHandshake(bool enabled)
+    {
+        if (m_ring || !m_sharedMemory->setHandshake(enabled))
+        {
+            return false;
+        }
+        m_handshake = enabled;
+        return true;
+    }
+
+    // True while the producer does not wait for this consumer although the handshake is enabled
+    // (a frame was not done within 1 s); the producer resumes it after the next frameDone().
+    bool handshakeSuspended() const
+    {
+        return m_handshake && m_sharedMemory->handshakeSuspended();
+    }
+
+    // Waits for a frame newer than the last one taken; false on timeout. Without frame sequence
+    // numbers, this is SharedMemory::wait(), which may miss a notification and has no timeout.
+    bool wait(const std::chrono::milliseconds &timeout)
+    {
+        if (m_ring)
+        {
+            return m_ring->waitForFrame(m_frameSequenceNumber, timeout);
+        }
+        if (m_handshake)
+        {
+            return m_sharedMemory->waitForFrame(m_frameSequenceNumber, timeout);
+        }
+        m_sharedMemory->wait();
+        return true;
+    }
+
+    // Calls copy(data) with the newest frame and returns (true, sample time stamp). From the frame
+    // ring, copy() is repeated if the frame was overwritten meanwhile; copy the part needed only.
+    template <typename Copy>
+    std::pair<bool, cluon::data::TimeStamp> take(Copy &&copy)
+    {
+        std::pair<bool, cluon::data::TimeStamp> sampleTime{false, cluon::data::TimeStamp()};
+        if (m_ring)
+        {
+            do
+            {
+                const char *data = m_ring->beginRead(m_frameSequenceNumber, sampleTime.second);
+                if (nullptr == data)
+                {
+                    return sampleTime;
+                }
+                copy(data);
+            } while (!m_ring->endRead());
+            sampleTime.first = true;
+            m_skipped = m_ring->skippedFrames();
+        }
+        else
+        {
+            m_sharedMemory->lock();
+            copy(m_sharedMemory->data());
+            sampleTime = m_sharedMemory->getTimeStamp();
+            m_frameSequenceNumber = m_sharedMemory->frameSequenceNumber();
+            m_skipped = m_sharedMemory->skippedFrames();
+            m_sharedMemory->unlock();
+        }
+        return sampleTime;
+    }
+
+    // Sequence number of the frame taken last (0 without frame sequence numbers).
+    uint64_t frameSequenceNumber() const
+    {
+        return m_frameSequenceNumber;
+    }
+
+    // Frames the producer wrote before the one taken last that were never taken.
+    uint64_t skippedFrames() const
+    {
+        return m_skipped;
+    }
+
+    // True if the producer has written a newer frame than the one taken last.
+    bool newerFrameAvailable() const
+    {
+        return (m_ring ? m_ring->frameSequenceNumber() : m_sharedMemory->frameSequenceNumber()) > m_frameSequenceNumber;
+    }
+
+    // Marks the frame taken last as processed; lets the producer continue in handshake mode.
+    void frameDone()
+    {
+        if (m_handshake)
+        {
+            m_sharedMemory->frameDone(m_frameSequenceNumber);
+        }
+    }
+
+private:
+    std::unique_ptr<cluon::SharedMemoryRing> m_ring;
+    std::unique_ptr<cluon::SharedMemory> m_sharedMemory;
+    bool m_handshake{false};
+    bool m_idleRingSkipped{false};
+    uint64_t m_frameSequenceNumber{0};
+    uint64_t m_skipped{0};
+};
+
+#endif
@@ -0,0 +1,120 @@
+/* Title: H264 Decoder - decodes the h264 ImageReadings of a recording into BGRA frames
+ * Authors: Nasit Vurgun, Sam Hardingham, Kai Rowley, Daniel van den Heuvel
+ * Institution: University of Gothenburg, Sweden
+ * Course: DIT638/DIT639 (2024), taught by Prof. Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef H264_DECODER_HPP
+#define H264_DECODER_HPP
+
+#include <opencv2/core/core.hpp>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavutil/frame.h>
+#include <libswscale/swscale.h>
+}
+
+#include <cstdint> // For fixed width integers
+#include <cstring> // For std::memcpy
+#include <string>  // For the encoded data
+#include <vector>  // For the padded input buffer
+
+// Decodes the h264 access units of opendlv.proxy.ImageReading (fourcc "h264") with libavcodec
+// into BGRA images, i.e., the same layout h264replay writes into the shared memory.
+// Frames have to be passed in recording order.
+class H264Decoder
+{
+private:
+    H264Decoder(const H264Decoder &) = delete;
+    H264Decoder(H264Decoder &&) = delete;
+    H264Decoder &operator=(const H264Decoder &) = delete;
+    H264Decoder &operator=(H264Decoder &&) = delete;
+
+public:
+    H264Decoder()
+        : m_context(nullptr), m_frame(nullptr), m_packet(nullptr), m_scaler(nullptr), m_buffer()
+    {
+        const AVCodec *codec = avcodec_find_decoder(AV_CODEC_ID_H264);
+        if (nullptr != codec)
+        {
+            m_context = avcodec_alloc_context3(codec);
+            m_frame = av_frame_alloc();
+            m_packet = av_packet_alloc();
+            if ((nullptr != m_context) && (0 != avcodec_open2(m_context, codec, nullptr)))
+            {
+                avcodec_free_context(&m_context);
+            }
+        }
+    }
+
+    ~H264Decoder()
+    {
+        sws_freeContext(m_scaler);
+        av_packet_free(&m_packet);
+        av_frame_free(&m_frame);
+        avcodec_free_context(&m_context);
+    }
+
+    bool valid() const
+    {
+        return (nullptr != m_context) && (nullptr != m_frame) && (nullptr != m_packet);
+    }
+
+    // Decodes one access unit; returns true if a picture was completed, which is then converted into bgra (CV_8UC4).
+    bool decode(const std::string &data, cv::Mat &bgra)
+    {
+        if (!valid() || data.empty())
+        {
+            return false;
+        }
+        // libavcodec reads up to AV_INPUT_BUFFER_PADDING_SIZE bytes past the end of the input.
+        m_buffer.assign(data.size() + AV_INPUT_BUFFER_PADDING_SIZE, 0);
+        std::memcpy(m_buffer.data(), data.data(), data.size());
+        m_packet->data = m_buffer.data();
+        m_packet->size = static_cast<int>(data.size());
+        if (0 != avcodec_send_packet(m_context, m_packet))
+        {
+            return false;
+        }
+
+        bool decoded{false};
+        while (0 == avcodec_receive_frame(m_context, m_frame))
+        {
+            bgra.create(m_frame->height, m_frame->width, CV_8UC4);
+            m_scaler = sws_getCachedContext(m_scaler, m_frame->width, m_frame->height, static_cast<AVPixelFormat>(m_frame->format),
+                                            m_frame->width, m_frame->height, AV_PIX_FMT_BGRA, SWS_POINT, nullptr, nullptr, nullptr);
+            if (nullptr != m_scaler)
+            {
+                uint8_t *planes[1] = {bgra.data};
+                const int strides[1] = {static_cast<int>(bgra.step)};
+                sws_scale(m_scaler, m_frame->data, m_frame->linesize, 0, m_frame->height, planes, strides);
+                decoded = true;
+            }
+            av_frame_unref(m_frame);
+        }
+        return decoded;
+    }
+
+private:
+    AVCodecContext *m_context;
+    AVFrame *m_frame;
+    AVPacket *m_packet;
+    SwsContext *m_scaler;
+    std::vector<uint8_t> m_buffer;
+};
+
+#endif
@@ -0,0 +1,320 @@
+/* Title: Latency Stats - per-stage timing of the frame loop with HDR-style histograms
+ * Authors: Nasit Vurgun, Sam Hardingham, Kai Rowley, Daniel van den Heuvel
+ * Institution: University of Gothenburg, Sweden
+ * Course: DIT638/DIT639 (2024), taught by Prof. Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LATENCY_STATS_HPP
+#define LATENCY_STATS_HPP
+
+#include <array>   // For the fixed bucket storage
+#include <chrono>  // For the monotonic clock
+#include <cstddef> // For std::size_t
+#include <cstdint> // For fixed width integers
+#include <iomanip> // For formatting the report
+#include <ostream> // For printing the report
+
+// Histogram of durations in microseconds with logarithmic buckets (as in HdrHistogram):
+// values below 128 us are counted exactly, above that every power of two is split into 64
+// linear buckets, so any reported percentile is at most 1/64 (1.6%) above the true value.
+// The buckets are a fixed array; recording never allocates.
+class LatencyHistogram
+{
+public:
+    static const uint32_t SUB_BUCKETS = 64;
+    static const uint32_t EXACT_LIMIT = 2 * SUB_BUCKETS;
+    static const std::size_t BUCKETS = EXACT_LIMIT + (31 - 7 + 1) * SUB_BUCKETS;
+
+    void record(uint64_t microseconds)
+    {
+        const uint32_t value = (microseconds > UINT32_MAX) ? UINT32_MAX : static_cast<uint32_t>(microseconds);
+        m_buckets[index(value)]++;
+        m_count++;
+        if (value > m_max)
+        {
+            m_max = value;
+        }
+    }
+
+    // Smallest recorded value v such that at least the fraction q of all samples is <= v
+    // (reported as the upper end of its bucket, capped at the maximum).
+    uint32_t percentile(double q) const
+    {
+        if (0 == m_count)
+        {
+            return 0;
+        }
+        uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(m_count) + 0.5);
+        rank = (rank < 1) ? 1 : ((rank > m_count) ? m_count : rank);
+        uint64_t seen = 0;
+        for (std::size_t i = 0; i < BUCKETS; i++)
+        {
+            seen += m_buckets[i];
+            if (seen >= rank)
+            {
+                const uint32_t upper = highestInBucket(i);
+                return (upper < m_max) ? upper : m_max;
+            }
+        }
+        return m_max;
+    }
+
+    uint64_t count() const { return m_count; }
+    uint32_t max() const { return m_max; }
+
+    void reset()
+    {
+        m_buckets.fill(0);
+        m_count = 0;
+        m_max = 0;
+    }
+
+private:
+    static std::size_t index(uint32_t value)
+    {
+        if (value < EXACT_LIMIT)
+        {
+            return value;
+        }
+        const uint32_t msb = 31 - static_cast<uint32_t>(__builtin_clz(value)); // >= 7
+        const uint32_t shift = msb - 6;
+        return EXACT_LIMIT + (msb - 7) * SUB_BUCKETS + ((value >> shift) - SUB_BUCKETS);
+    }
+
+    static uint32_t highestInBucket(std::size_t i)
+    {
+        if (i < EXACT_LIMIT)
+        {
+            return static_cast<uint32_t>(i);
+        }
+        const uint32_t msb = static_cast<uint32_t>((i - EXACT_LIMIT) / SUB_BUCKETS) + 7;
+        const uint64_t sub = (i - EXACT_LIMIT) % SUB_BUCKETS + SUB_BUCKETS;
+        const uint64_t upper = ((sub + 1) << (msb - 6)) - 1;
+        return (upper > UINT32_MAX) ? UINT32_MAX : static_cast<uint32_t>(upper);
+    }
+
+    std::array<uint64_t, BUCKETS> m_buckets{};
+    uint64_t m_count{0};
+    uint32_t m_max{0};
+};
+
+// Stages of the frame loop. The colour conversion and the thresholding are a single fused
+// kernel (cone-mask.hpp), so they are reported together as MASKS.
+enum class Stage : uint8_t
+{
+    WAIT,      // waiting for the next frame in the shared memory
+    LOCK_COPY, // lock, ROI snapshot, time stamp, unlock
+    BLUR,      // prefilter
+    MASKS,     // BGR -> HSV -> colour thresholds
+    CONTOURS,  // blob detection per colour
+    STEERING,  // steering angle computation
+    OUTPUT,    // publishing, ground truth comparison, display
+    FRAME,     // everything after WAIT up to the end of OUTPUT
+    COUNT
+};
+
+const std::size_t STAGES = static_cast<std::size_t>(Stage::COUNT);
+
+inline const char *stageName(Stage stage)
+{
+    static const char *NAMES[STAGES] = {"wait", "lock/copy", "blur", "hsv+masks", "contours", "steering", "output", "frame"};
+    return NAMES[static_cast<std::size_t>(stage)];
+}
+
+// Takes monotonic timestamps between the stages of one frame and aggregates them per stage.
+class PipelineTimer
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    // Starts a frame; the next mark() measures the first stage (WAIT).
+    void begin()
+    {
+        m_last = Clock::now();
+    }
+
+    // Records the time since the previous mark (or begin) for stage; the FRAME total starts after WAIT.
+    void mark(Stage stage)
+    {
+        const Clock::time_point now = Clock::now();
+        m_histograms[static_cast<std::size_t>(stage)].record(microseconds(now - m_last));
+        if (Stage::WAIT == stage)
+        {
+            m_frameStart = now;
+        }
+        m_last = now;
+    }
+
+    // Records the FRAME total after the last stage.
+    void end()
+    {
+        m_histograms[static_cast<std::size_t>(Stage::FRAME)].record(microseconds(m_last - m_frameStart));
+    }
+
+    const LatencyHistogram &histogram(Stage stage) const
+    {
+        return m_histograms[static_cast<std::size_t>(stage)];
+    }
+
+    // True once interval has passed since the last report.
+    bool reportDue(std::chrono::milliseconds interval) const
+    {
+        return (Clock::now() - m_lastReport) >= interval;
+    }
+
+    // Starts a new reporting interval.
+    void reset()
+    {
+        for (auto &histogram : m_histograms)
+        {
+            histogram.reset();
+        }
+        m_lastReport = Clock::now();
+    }
+
+    // Prints p50/p99/p99.9/max per stage.
+    void print(std::ostream &out) const
+    {
+        out << std::left << std::setw(11) << "stage" << std::right << std::setw(9) << "samples" << std::setw(10) << "p50 us"
+            << std::setw(10) << "p99 us" << std::setw(10) << "p99.9 us" << std::setw(10) << "max us" << std::endl;
+        for (std::size_t i = 0; i < STAGES; i++)
+        {
+            const LatencyHistogram &h = m_histograms[i];
+            out << std::left << std::setw(11) << stageName(static_cast<Stage>(i)) << std::right << std::setw(9) << h.count()
+                << std::setw(10) << h.percentile(0.5) << std::setw(10) << h.percentile(0.99) << std::setw(10) << h.percentile(0.999)
+                << std::setw(10) << h.max() << std::endl;
+        }
+    }
+
+private:
+    static uint64_t microseconds(Clock::duration d)
+    {
+        const int64_t us = std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+        return (us < 0) ? 0 : static_cast<uint64_t>(us);
+    }
+
+    std::array<LatencyHistogram, STAGES> m_histograms{};
+    Clock::time_point m_last{};
+    Clock::time_point m_frameStart{};
+    Clock::time_point m_lastReport{Clock::now()};
+};
+
+// Tracks the latency from frame capture (sample time stamp of the shared memory) to
+// publishing the steering request against a fixed budget.
+class DeadlineMonitor
+{
+public:
+    explicit DeadlineMonitor(std::chrono::microseconds budget)
+        : m_budget(budget), m_histogram()
+    {
+    }
+
+    // Records one frame; returns false if the budget was exceeded.
+    bool record(int64_t captureToPublishMicroseconds)
+    {
+        const uint64_t latency = (captureToPublishMicroseconds < 0) ? 0 : static_cast<uint64_t>(captureToPublishMicroseconds);
+        m_histogram.record(latency);
+        if (latency > static_cast<uint64_t>(m_budget.count()))
+        {
+            m_misses++;
+            m_totalMisses++;
+            return false;
+        }
+        return true;
+    }
+
+    std::chrono::microseconds budget() const { return m_budget; }
+    const LatencyHistogram &histogram() const { return m_histogram; }
+    // Misses in the current reporting interval and since start.
+    uint64_t misses() const { return m_misses; }
+    uint64_t totalMisses() const { return m_totalMisses; }
+
+    void print(std::ostream &out) const
+    {
+        out << "capture->publish: p50 " << m_histogram.percentile(0.5) << " us, p99 " << m_histogram.percentile(0.99)
+            << " us, max " << m_histogram.max() << " us, " << m_misses << "/" << m_histogram.count()
+            << " over the " << m_budget.count() / 1000.0 << " ms budget (" << m_totalMisses << " since start)" << std::endl;
+    }
+
+    // Starts a new reporting interval.
+    void reset()
+    {
+        m_histogram.reset();
+        m_misses = 0;
+    }
+
+private:
+    std::chrono::microseconds m_budget;
+    LatencyHistogram m_histogram;
+    uint64_t m_misses{0};
+    uint64_t m_totalMisses{0};
+};
+
+// Counts the processed frames, the frames that were overwritten in the shared memory before
+// they could be taken (dropped, see cluon::SharedMemory::skippedFrames()), and the frames whose
+// processing ended after the next frame had already arrived (late).
+class FrameCounter
+{
+public:
+    // Records a processed frame and the frames dropped before it.
+    void record(uint64_t dropped, bool late)
+    {
+        m_frames++;
+        m_dropped += dropped;
+        m_totalDropped += dropped;
+        if (late)
+        {
+            m_late++;
+            m_totalLate++;
+        }
+    }
+
+    // Frames in the current reporting interval and since start.
+    uint64_t frames() const { return m_frames; }
+    uint64_t dropped() const { return m_dropped; }
+    uint64_t late() const { return m_late; }
+    uint64_t totalDropped() const { return m_totalDropped; }
+    uint64_t totalLate() const { return m_totalLate; }
+
+    // Share of the produced frames in the current reporting interval that were dropped.
+    double dropRate() const
+    {
+        return (0 == m_frames + m_dropped) ? 0.0 : static_cast<double>(m_dropped) / static_cast<double>(m_frames + m_dropped);
+    }
+
+    void print(std::ostream &out) const
+    {
+        out << "frames: " << m_frames << " processed, " << m_dropped << " dropped (" << 100.0 * dropRate() << "%), " << m_late << " late ("
+            << m_totalDropped << " dropped, " << m_totalLate << " late since start)" << std::endl;
+    }
+
+    // Starts a new reporting interval.
+    void reset()
+    {
+        m_frames = 0;
+        m_dropped = 0;
+        m_late = 0;
+    }
+
+private:
+    uint64_t m_frames{0};
+    uint64_t m_dropped{0};
+    uint64_t m_late{0};
+    uint64_t m_totalDropped{0};
+    uint64_t m_totalLate{0};
+};
+
+#endif
@@ -0,0 +1,158 @@
+/* Title: Prefilter Benchmark - ms/frame and detection deviation of the blurring strategies
+ * Authors: Nasit Vurgun, Sam Hardingham, Kai Rowley, Daniel van den Heuvel
+ * Institution: University of Gothenburg, Sweden
+ * Course: DIT638/DIT639 (2024), taught by Prof. Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Include the single-file, header-only middleware libcluon for parsing the command line
+#include "cluon-complete.hpp"
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include "cone-detection.hpp"
+#include "cone-mask.hpp"
+#include "prefilter.hpp"
+#include "steering-core.hpp"
+
+#include <algorithm> // For std::max
+#include <chrono>    // For timing
+#include <cstdlib>   // For std::abs(int)
+#include <iomanip>   // For formatting the report
+#include <iostream>  // For printing the report
+#include <string>    // For strings
+#include <vector>    // For the frame set
+
+// Same ROI size and HSV ranges (steering-core.hpp) as the microservice.
+const cv::Size ROI_SIZE(STEERING_ROI.width, STEERING_ROI.height);
+
+// Cone colours in BGR(A) that fall into the HSV ranges above.
+const cv::Scalar YELLOW_CONE_BGRA(66, 135, 135, 255);
+const cv::Scalar BLUE_CONE_BGRA(150, 91, 61, 255);
+
+// Midpoints detected in one frame.
+struct Detection
+{
+    cv::Point yellow;
+    cv::Point blue;
+};
+
+// Synthetic ROI: noisy dark track with a yellow and a blue cone moving across the frames.
+std::vector<cv::Mat> makeFrames(int count)
+{
+    std::vector<cv::Mat> frames;
+    for (int i = 0; i < count; i++)
+    {
+        cv::Mat frame(ROI_SIZE.height, ROI_SIZE.width, CV_8UC4);
+        cv::randu(frame, cv::Scalar(30, 30, 30, 255), cv::Scalar(90, 90, 90, 255));
+        const int shift = (i * 7) % 200;
+        cv::rectangle(frame, cv::Rect(380 + shift / 2, 40 + (i % 30), 22, 36), YELLOW_CONE_BGRA, -1);
+        cv::rectangle(frame, cv::Rect(40 + shift, 50 + (i % 20), 26, 40), BLUE_CONE_BGRA, -1);
+        // A smaller distractor per colour so the largest-region selection matters.
+        cv::rectangle(frame, cv::Rect(560, 10, 6, 8), YELLOW_CONE_BGRA, -1);
+        cv::rectangle(frame, cv::Rect(300, 100, 5, 9), BLUE_CONE_BGRA, -1);
+        frames.push_back(frame);
+    }
+    return frames;
+}
+
+// Runs the detection part of the microservice on a blurred ROI.
+Detection detect(const cv::Mat &blurred, cv::Mat &yellowMask, cv::Mat &blueMask, BlobDetector &detector)
+{
+    Detection detection{cv::Point(-1, -1), cv::Point(-1, -1)};
+    fusedConeMasks(blurred, YELLOW_MIN, YELLOW_MAX, BLUE_MIN, BLUE_MAX, yellowMask, blueMask);
+    cv::Rect rect;
+    if (findLargestCone(detector, yellowMask, rect))
+    {
+        detection.yellow = coneMidpoint(rect, DETECTION_THRESHOLD);
+    }
+    if (findLargestCone(detector, blueMask, rect))
+    {
+        detection.blue = coneMidpoint(rect, DETECTION_THRESHOLD);
+    }
+    return detection;
+}
+
+int pointDeviation(const cv::Point &a, const cv::Point &b)
+{
+    return std::max(std::abs(a.x - b.x), std::abs(a.y - b.y));
+}
+
+int32_t main(int32_t argc, char **argv)
+{
+    auto commandlineArguments = cluon::getCommandlineArguments(argc, argv);
+    if (0 != commandlineArguments.count("help"))
+    {
+        std::cerr << argv[0] << " measures the blurring strategies of the microservice on a " << ROI_SIZE.width << "x" << ROI_SIZE.height << " ROI." << std::endl;
+        std::cerr << "Usage:   " << argv[0] << " [--frames=<n>] [--sigma=<sigma>] [--tolerance=<px>]" << std::endl;
+        std::cerr << "         --frames:    number of synthetic frames to process per strategy (default: 300)" << std::endl;
+        std::cerr << "         --sigma:     sigma of the blurring stage (default: 2.5)" << std::endl;
+        std::cerr << "         --tolerance: allowed deviation of cone midpoints from the legacy path in pixels (default: 3)" << std::endl;
+        return 1;
+    }
+    const int FRAMES{(commandlineArguments.count("frames") != 0) ? std::stoi(commandlineArguments["frames"]) : 300};
+    const double SIGMA{(commandlineArguments.count("sigma") != 0) ? std::stod(commandlineArguments["sigma"]) : DEFAULT_PREFILTER_SIGMA};
+    const int TOLERANCE{(commandlineArguments.count("tolerance") != 0) ? std::stoi(commandlineArguments["tolerance"]) : 3};
+
+    const std::vector<cv::Mat> frames = makeFrames(std::max(1, FRAMES));
+    const PrefilterMode modes[] = {PrefilterMode::LEGACY, PrefilterMode::AUTO, PrefilterMode::BOX, PrefilterMode::PYRAMID, PrefilterMode::NONE};
+
+    cv::Mat blurred, yellowMask, blueMask;
+    BlobDetector detector{ROI_SIZE.height, ROI_SIZE.width};
+    std::vector<Detection> reference;
+    int32_t retCode{0};
+
+    std::cout << std::left << std::setw(10) << "prefilter" << std::right << std::setw(12) << "ms/frame" << std::setw(16) << "max dev (px)" << "  result" << std::endl;
+    for (PrefilterMode mode : modes)
+    {
+        Prefilter prefilter{mode, SIGMA};
+        // Warm up so that the intermediate buffers are allocated before timing.
+        prefilter.apply(frames[0], blurred);
+
+        auto start = std::chrono::steady_clock::now();
+        for (const cv::Mat &frame : frames)
+        {
+            prefilter.apply(frame, blurred);
+        }
+        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        const double msPerFrame = static_cast<double>(duration) / 1000.0 / static_cast<double>(frames.size());
+
+        // Compare the detected midpoints against the legacy path.
+        int maxDeviation = 0;
+        for (size_t i = 0; i < frames.size(); i++)
+        {
+            prefilter.apply(frames[i], blurred);
+            Detection detection = detect(blurred, yellowMask, blueMask, detector);
+            if (PrefilterMode::LEGACY == mode)
+            {
+                reference.push_back(detection);
+            }
+            maxDeviation = std::max(maxDeviation, pointDeviation(detection.yellow, reference[i].yellow));
+            maxDeviation = std::max(maxDeviation, pointDeviation(detection.blue, reference[i].blue));
+        }
+        // Without blurring, the output is reported for comparison only.
+        const bool withinTolerance = (maxDeviation <= TOLERANCE);
+        const char *result = (PrefilterMode::NONE == mode) ? "(reference only)" : (withinTolerance ? "ok" : "OUT OF TOLERANCE");
+        if (!withinTolerance && (PrefilterMode::NONE != mode))
+        {
+            retCode = 1;
+        }
+
+        std::cout << std::left << std::setw(10) << prefilterName(mode) << std::right << std::setw(12) << std::fixed << std::setprecision(3) << msPerFrame
+                  << std::setw(16) << maxDeviation << "  " << result << std::endl;
+    }
+    return retCode;
+}
@@ -0,0 +1,166 @@
+/* Title: Prefilter - configurable blurring stage applied to the ROI before colour segmentation
+ * Authors: Nasit Vurgun, Sam Hardingham, Kai Rowley, Daniel van den Heuvel
+ * Institution: University of Gothenburg, Sweden
+ * Course: DIT638/DIT639 (2024), taught by Prof. Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PREFILTER_HPP
+#define PREFILTER_HPP
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include <cmath>  // For std::sqrt, std::floor, std::ceil
+#include <string> // For mode names
+
+// Available blurring strategies; all of them approximate a Gaussian with the configured sigma.
+enum class PrefilterMode
+{
+    LEGACY,  // 101x101 Gaussian kernel as used originally (reference path)
+    AUTO,    // Gaussian kernel sized from sigma (+/- 3 sigma)
+    BOX,     // three stacked box blurs with sizes chosen to match sigma
+    PYRAMID, // downsample by 2, blur with sigma/2, upsample again
+    NONE     // no blurring
+};
+
+// Kernel size used by the original implementation.
+const int LEGACY_KERNEL_SIZE = 101;
+
+// Default sigma of the blurring stage.
+const double DEFAULT_PREFILTER_SIGMA = 2.5;
+
+inline const char *prefilterName(PrefilterMode mode)
+{
+    switch (mode)
+    {
+    case PrefilterMode::LEGACY:
+        return "legacy";
+    case PrefilterMode::AUTO:
+        return "auto";
+    case PrefilterMode::BOX:
+        return "box";
+    case PrefilterMode::PYRAMID:
+        return "pyramid";
+    case PrefilterMode::NONE:
+        return "none";
+    }
+    return "unknown";
+}
+
+// Parses a --prefilter= value; returns false for unknown names and leaves mode untouched.
+inline bool parsePrefilterMode(const std::string &name, PrefilterMode &mode)
+{
+    const PrefilterMode modes[] = {PrefilterMode::LEGACY, PrefilterMode::AUTO, PrefilterMode::BOX, PrefilterMode::PYRAMID, PrefilterMode::NONE};
+    for (PrefilterMode m : modes)
+    {
+        if (name == prefilterName(m))
+        {
+            mode = m;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Odd Gaussian kernel size covering +/- 3 sigma.
+inline int gaussianKernelSize(double sigma)
+{
+    int size = 2 * static_cast<int>(std::ceil(3.0 * sigma)) + 1;
+    return (size < 3) ? 3 : size;
+}
+
+// Blurring stage that keeps its intermediate images between frames so that
+// no memory is allocated once the first frame has been processed.
+class Prefilter
+{
+public:
+    explicit Prefilter(PrefilterMode mode = PrefilterMode::LEGACY, double sigma = DEFAULT_PREFILTER_SIGMA)
+        : m_mode(mode), m_sigma(sigma), m_kernelSize(gaussianKernelSize(sigma)), m_boxSizes{1, 1, 1}, m_small(), m_smallBlurred(), m_scratch()
+    {
+        computeBoxSizes();
+    }
+
+    PrefilterMode mode() const { return m_mode; }
+    double sigma() const { return m_sigma; }
+
+    // Blurs src into dst; dst must not alias src.
+    void apply(const cv::Mat &src, cv::Mat &dst)
+    {
+        switch (m_mode)
+        {
+        case PrefilterMode::LEGACY:
+            cv::GaussianBlur(src, dst, cv::Size(LEGACY_KERNEL_SIZE, LEGACY_KERNEL_SIZE), m_sigma);
+            break;
+        case PrefilterMode::AUTO:
+            cv::GaussianBlur(src, dst, cv::Size(m_kernelSize, m_kernelSize), m_sigma);
+            break;
+        case PrefilterMode::BOX:
+            // Ping-pong between dst and the scratch buffer; three passes end in dst.
+            cv::blur(src, dst, cv::Size(m_boxSizes[0], m_boxSizes[0]));
+            cv::blur(dst, m_scratch, cv::Size(m_boxSizes[1], m_boxSizes[1]));
+            cv::blur(m_scratch, dst, cv::Size(m_boxSizes[2], m_boxSizes[2]));
+            break;
+        case PrefilterMode::PYRAMID:
+        {
+            const double halfSigma = m_sigma / 2.0;
+            const int halfKernelSize = gaussianKernelSize(halfSigma);
+            cv::resize(src, m_small, cv::Size((src.cols + 1) / 2, (src.rows + 1) / 2), 0, 0, cv::INTER_AREA);
+            cv::GaussianBlur(m_small, m_smallBlurred, cv::Size(halfKernelSize, halfKernelSize), halfSigma);
+            cv::resize(m_smallBlurred, dst, src.size(), 0, 0, cv::INTER_LINEAR);
+            break;
+        }
+        case PrefilterMode::NONE:
+            src.copyTo(dst);
+            break;
+        }
+    }
+
+private:
+    // Box sizes for three passes whose combined variance matches sigma^2
+    // (see W. Jarosz, "Fast Image Convolutions", and P. Kutskir, "Fastest Gaussian Blur").
+    void computeBoxSizes()
+    {
+        const int passes = 3;
+        const double variance = m_sigma * m_sigma;
+        const double idealWidth = std::sqrt(12.0 * variance / passes + 1.0);
+        int lower = static_cast<int>(std::floor(idealWidth));
+        if (lower % 2 == 0)
+        {
+            lower--;
+        }
+        if (lower < 1)
+        {
+            lower = 1;
+        }
+        const int upper = lower + 2;
+        const double m = (12.0 * variance - passes * lower * lower - 4.0 * passes * lower - 3.0 * passes) / (-4.0 * lower - 4.0);
+        const int lowerPasses = static_cast<int>(std::lround(m));
+        for (int i = 0; i < passes; i++)
+        {
+            m_boxSizes[i] = (i < lowerPasses) ? lower : upper;
+        }
+    }
+
+    PrefilterMode m_mode;
+    double m_sigma;
+    int m_kernelSize;
+    int m_boxSizes[3];
+    cv::Mat m_small;
+    cv::Mat m_smallBlurred;
+    cv::Mat m_scratch;
+};
+
+#endif
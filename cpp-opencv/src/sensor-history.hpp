@@ -0,0 +1,216 @@
+/* Title: Sensor History - time stamped sensor samples for aligning the inputs with a frame
+ * Authors: Nasit Vurgun, Sam Hardingham, Kai Rowley, Daniel van den Heuvel
+ * Institution: University of Gothenburg, Sweden
+ * Course: DIT638/DIT639 (2024), taught by Prof. Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SENSOR_HISTORY_HPP
+#define SENSOR_HISTORY_HPP
+
+#include <array>   // For the ring storage
+#include <atomic>  // For the slots and the write position
+#include <cstddef> // For std::size_t
+#include <cstdint> // For fixed width integers
+#include <string>  // For the mode names
+
+// How a sensor value is matched to the time stamp of a frame.
+enum class Alignment
+{
+    LATEST,      // newest sample, regardless of its time stamp (previous behaviour)
+    NEAREST,     // sample closest in time
+    INTERPOLATE, // linear interpolation between the samples before and after; the nearest one at the ends
+};
+
+inline const char *alignmentName(Alignment alignment)
+{
+    switch (alignment)
+    {
+    case Alignment::LATEST:
+        return "latest";
+    case Alignment::NEAREST:
+        return "nearest";
+    case Alignment::INTERPOLATE:
+        return "interpolate";
+    }
+    return "unknown";
+}
+
+// Returns false if name is not a known alignment.
+inline bool parseAlignment(const std::string &name, Alignment &alignment)
+{
+    const Alignment alignments[] = {Alignment::LATEST, Alignment::NEAREST, Alignment::INTERPOLATE};
+    for (Alignment candidate : alignments)
+    {
+        if (name == alignmentName(candidate))
+        {
+            alignment = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Sensor value at a requested time.
+struct AlignedValue
+{
+    bool valid;      // false if no sample has been received yet
+    double value;
+    int64_t offset;  // time stamp of the (nearest) sample used minus the requested time in microseconds
+};
+
+// Fixed-capacity ring of the last CAPACITY samples (sample time stamp in microseconds, value)
+// of one sensor. One thread (the OD4 callback) appends, any thread can look up the value at a
+// given time without locking: a reader scans the slots below the published write position and
+// discards the scan if the writer has wrapped around onto the slots it read in the meantime.
+// Samples are expected in (mostly) increasing time order, as they arrive from the bus.
+template <std::size_t CAPACITY>
+class SensorHistory
+{
+    static_assert(CAPACITY >= 2, "SensorHistory needs at least two slots");
+
+private:
+    SensorHistory(const SensorHistory &) = delete;
+    SensorHistory(SensorHistory &&) = delete;
+    SensorHistory &operator=(const SensorHistory &) = delete;
+    SensorHistory &operator=(SensorHistory &&) = delete;
+
+public:
+    SensorHistory() = default;
+
+    // Single writer only.
+    void append(int64_t sampleTime, double value)
+    {
+        const uint64_t head = m_head.load(std::memory_order_relaxed);
+        Slot &slot = m_slots[head % CAPACITY];
+        // Announce the overwrite before touching the slot, so readers can detect it.
+        m_writing.store(head + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.sampleTime.store(sampleTime, std::memory_order_relaxed);
+        slot.value.store(value, std::memory_order_relaxed);
+        m_head.store(head + 1, std::memory_order_release);
+    }
+
+    uint64_t size() const
+    {
+        const uint64_t head = m_head.load(std::memory_order_acquire);
+        return (head < CAPACITY) ? head : CAPACITY;
+    }
+
+    AlignedValue at(int64_t time, Alignment alignment) const
+    {
+        while (true)
+        {
+            AlignedValue result{false, 0.0, 0};
+            const uint64_t head = m_head.load(std::memory_order_acquire);
+            if (0 == head)
+            {
+                return result;
+            }
+            // The slot being written next is excluded, the oldest one is head - CAPACITY + 1.
+            const uint64_t count = (head < CAPACITY) ? head : CAPACITY - 1;
+
+            Sample newest = read(head - 1);
+            Sample before{INT64_MIN, 0.0};
+            Sample after{INT64_MAX, 0.0};
+            if (Alignment::LATEST != alignment)
+            {
+                // Closest samples at or before and after time; slots are scanned newest first.
+                for (uint64_t i = 0; i < count; i++)
+                {
+                    const Sample sample = read(head - 1 - i);
+                    if ((sample.sampleTime <= time) && (sample.sampleTime > before.sampleTime))
+                    {
+                        before = sample;
+                    }
+                    else if ((sample.sampleTime > time) && (sample.sampleTime < after.sampleTime))
+                    {
+                        after = sample;
+                    }
+                    if ((INT64_MIN != before.sampleTime) && (sample.sampleTime < before.sampleTime))
+                    {
+                        // Everything older than the sample before time is irrelevant.
+                        break;
+                    }
+                }
+            }
+
+            // Retry if the writer started to overwrite one of the slots that were read.
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (m_writing.load(std::memory_order_relaxed) > head - count + CAPACITY)
+            {
+                continue;
+            }
+
+            result.valid = true;
+            if (Alignment::LATEST == alignment)
+            {
+                result.value = newest.value;
+                result.offset = newest.sampleTime - time;
+            }
+            else if (INT64_MIN == before.sampleTime)
+            {
+                result.value = after.value;
+                result.offset = after.sampleTime - time;
+            }
+            else if (INT64_MAX == after.sampleTime)
+            {
+                result.value = before.value;
+                result.offset = before.sampleTime - time;
+            }
+            else
+            {
+                const bool beforeIsNearer = (time - before.sampleTime) <= (after.sampleTime - time);
+                const Sample &nearest = beforeIsNearer ? before : after;
+                result.offset = nearest.sampleTime - time;
+                if (Alignment::NEAREST == alignment)
+                {
+                    result.value = nearest.value;
+                }
+                else
+                {
+                    const double t = static_cast<double>(time - before.sampleTime) / static_cast<double>(after.sampleTime - before.sampleTime);
+                    result.value = before.value + t * (after.value - before.value);
+                }
+            }
+            return result;
+        }
+    }
+
+private:
+    struct Slot
+    {
+        std::atomic<int64_t> sampleTime{0};
+        std::atomic<double> value{0.0};
+    };
+
+    struct Sample
+    {
+        int64_t sampleTime;
+        double value;
+    };
+
+    Sample read(uint64_t index) const
+    {
+        const Slot &slot = m_slots[index % CAPACITY];
+        return Sample{slot.sampleTime.load(std::memory_order_relaxed), slot.value.load(std::memory_order_relaxed)};
+    }
+
+    std::array<Slot, CAPACITY> m_slots{};
+    std::atomic<uint64_t> m_head{0};    // number of completed appends
+    std::atomic<uint64_t> m_writing{0}; // number of started appends
+};
+
+#endif
@@ -0,0 +1,127 @@
+/* Title: Sensor Mailbox - latest value of a sensor input shared between the OD4 and the frame loop
+ * Authors: Nasit Vurgun, Sam Hardingham, Kai Rowley, Daniel van den Heuvel
+ * Institution: University of Gothenburg, Sweden
+ * Course: DIT638/DIT639 (2024), taught by Prof. Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SENSOR_MAILBOX_HPP
+#define SENSOR_MAILBOX_HPP
+
+#include <array>       // For the payload words
+#include <atomic>      // For the sequence counter
+#include <cstddef>     // For std::size_t
+#include <cstdint>     // For fixed width integers
+#include <cstring>     // For std::memcpy
+#include <thread>      // For std::this_thread::yield
+#include <type_traits> // For std::is_trivially_copyable
+
+// Consistent copy of a mailbox.
+template <typename T>
+struct SensorSample
+{
+    T value;
+    int64_t sampleTime; // sample time stamp of the envelope in microseconds
+    uint64_t updates;   // number of store() calls so far; 0 if nothing has been received yet
+};
+
+// Holds the latest value of a sensor input together with its sample time stamp (a seqlock).
+// store() is called from the OD4 callbacks, load() from the frame loop. Readers never block
+// the writer and take no lock: a read that overlaps a store is simply repeated. The payload
+// is kept in relaxed atomic words, so concurrent access is well-defined without a mutex.
+// Concurrent writers are serialized on the sequence counter.
+template <typename T>
+class SensorMailbox
+{
+    static_assert(std::is_trivially_copyable<T>::value, "SensorMailbox requires a trivially copyable value type");
+
+private:
+    SensorMailbox(const SensorMailbox &) = delete;
+    SensorMailbox(SensorMailbox &&) = delete;
+    SensorMailbox &operator=(const SensorMailbox &) = delete;
+    SensorMailbox &operator=(SensorMailbox &&) = delete;
+
+public:
+    SensorMailbox() = default;
+
+    void store(const T &value, int64_t sampleTime)
+    {
+        const Payload payload{value, sampleTime};
+        std::array<uint64_t, WORDS> words{};
+        std::memcpy(words.data(), &payload, sizeof(payload));
+
+        // An odd sequence marks a store in progress.
+        uint64_t sequence = m_sequence.load(std::memory_order_relaxed);
+        while ((0 != (sequence & 1)) ||
+               !m_sequence.compare_exchange_weak(sequence, sequence + 1, std::memory_order_acquire, std::memory_order_relaxed))
+        {
+            std::this_thread::yield();
+            sequence = m_sequence.load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+        for (std::size_t i = 0; i < WORDS; i++)
+        {
+            m_words[i].store(words[i], std::memory_order_relaxed);
+        }
+        m_sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    SensorSample<T> load() const
+    {
+        std::array<uint64_t, WORDS> words{};
+        uint64_t sequence;
+        while (true)
+        {
+            sequence = m_sequence.load(std::memory_order_acquire);
+            if (0 != (sequence & 1))
+            {
+                continue;
+            }
+            for (std::size_t i = 0; i < WORDS; i++)
+            {
+                words[i] = m_words[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (m_sequence.load(std::memory_order_relaxed) == sequence)
+            {
+                break;
+            }
+        }
+        Payload payload;
+        std::memcpy(&payload, words.data(), sizeof(payload));
+        return SensorSample<T>{payload.value, payload.sampleTime, sequence / 2};
+    }
+
+    // Latest value, or fallback if nothing has been received yet.
+    T value(const T &fallback = T()) const
+    {
+        const SensorSample<T> sample = load();
+        return (0 == sample.updates) ? fallback : sample.value;
+    }
+
+private:
+    struct Payload
+    {
+        T value;
+        int64_t sampleTime;
+    };
+
+    static const std::size_t WORDS = (sizeof(Payload) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    std::atomic<uint64_t> m_sequence{0};
+    std::array<std::atomic<uint64_t>, WORDS> m_words{};
+};
+
+#endif
@@ -0,0 +1,213 @@
+/* Title: Steering Core - steering angle from cone positions and sensor readings
+ * Authors: Nasit Vurgun, Sam Hardingham, Kai Rowley, Daniel van den Heuvel
+ * Institution: University of Gothenburg, Sweden
+ * Course: DIT638/DIT639 (2024), taught by Prof. Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef STEERING_CORE_HPP
+#define STEERING_CORE_HPP
+
+#include <opencv2/core/core.hpp>
+
+#include <array>   // For the error histogram
+#include <cmath>   // For std::atan, std::abs
+#include <cstddef> // For std::size_t
+
+// Cropping rectangle of the camera image (640x480) that is searched for cones.
+const cv::Rect STEERING_ROI(0, 255, 640, 144);
+
+// HSV colour ranges of the yellow and blue cones (min and max H, S, and V values).
+const cv::Scalar YELLOW_MIN(20, 60, 70);
+const cv::Scalar YELLOW_MAX(40, 200, 200);
+const cv::Scalar BLUE_MIN(100, 50, 30);
+const cv::Scalar BLUE_MAX(120, 255, 253);
+
+// Steering function from curve fitting of the ground steering against the angular velocity Z.
+inline double steering_function(double X)
+{
+    // Coefficients
+    double a = 0.14973124;  // approximately half of steering range
+    double b = 0.02949003;  // scaling factor for angular velocity Z
+    double c = -0.00177955; // this can even be zero!
+
+    // Calculate and return the result
+    return a * std::atan(b * X) + c;
+}
+
+// Cones found in one frame; a midpoint is only valid if the cone was found.
+struct ConeObservation
+{
+    bool yellow;
+    bool blue;
+    cv::Point midYellow; // center of rect containing yellow cone
+    cv::Point midBlue;   // center of rect containing blue cone
+};
+
+// Steering angle computation shared by the microservice and the offline evaluation.
+// The cone positions and the clockwise counter are kept across frames: a cone that is
+// not seen in a frame keeps its last position.
+class SteeringCore
+{
+public:
+    double update(const ConeObservation &cones, double angularVelocityZ, double distance)
+    {
+        if (cones.yellow)
+        {
+            m_midYellow = cones.midYellow;
+        }
+        if (cones.blue)
+        {
+            m_midBlue = cones.midBlue;
+        }
+
+        // Calculate steering angle (not optimized)
+        if (cones.blue && cones.yellow)
+        {
+            // check CW or CCW
+            if (m_midBlue.x / m_midBlue.y < m_midYellow.x / m_midYellow.y)
+            {
+                m_clockwise++;
+            }
+        }
+
+        // Appling steering function to angular velocity Z sensor reading
+        double steeringWheelAngle = steering_function(angularVelocityZ);
+
+        // Apply offsets - based on trends observed from image analysis
+        if (m_clockwise < 0)
+        {
+            // Case: CCW
+            if (m_midBlue.x < 500)
+            {
+                steeringWheelAngle = steeringWheelAngle + 0.05;
+            }
+            if (m_midYellow.x > 125)
+            {
+                steeringWheelAngle = steeringWheelAngle - 0.05;
+            }
+            else
+            {
+                steeringWheelAngle = steeringWheelAngle + 0.05;
+            }
+        }
+        else
+        {
+            // Case: CW
+            if (m_midBlue.x > 200)
+            {
+                steeringWheelAngle = steeringWheelAngle - 0.05;
+            }
+            if (m_midYellow.x < 500)
+            {
+                steeringWheelAngle = steeringWheelAngle + 0.05;
+            }
+        }
+
+        // Use multiplier at close distances
+        if (distance < 0.2)
+        {
+            steeringWheelAngle = 1.2 * steeringWheelAngle;
+        }
+
+        // Apply thresholds to steer hard left and hard right
+        if (steeringWheelAngle > 0.155)
+        {
+            steeringWheelAngle = 0.22;
+        }
+        else if (steeringWheelAngle < -0.15)
+        {
+            steeringWheelAngle = -0.22;
+        }
+        return steeringWheelAngle;
+    }
+
+    // Positive if clockwise
+    int clockwise() const { return m_clockwise; }
+
+private:
+    int m_clockwise{0};
+    cv::Point m_midYellow{0, 0};
+    cv::Point m_midBlue{0, 0};
+};
+
+// Compares the computed steering angles with the ground truth: a frame is correct if the
+// computed angle is within 25% of the actual one; frames without steering are not counted.
+// The counted frames are also binned by their error relative to the actual angle.
+class SteeringScore
+{
+public:
+    // Upper bounds (inclusive) of the relative error bins in percent; the last bin takes the rest.
+    static const std::size_t ERROR_BINS = 8;
+    static const std::array<int, ERROR_BINS - 1> &errorBinLimits()
+    {
+        static const std::array<int, ERROR_BINS - 1> LIMITS{{5, 10, 15, 20, 25, 50, 100}};
+        return LIMITS;
+    }
+
+    // Returns true if the frame was counted.
+    bool add(double computed, double actual)
+    {
+        // Check if there was 0 steering
+        if (std::abs(actual) < 0.0001)
+        {
+            return false;
+        }
+        m_frames++;
+        const double error = std::abs(computed - actual);
+        if (error <= std::abs(0.25 * actual))
+        {
+            m_correct++;
+        }
+        std::size_t bin = 0;
+        while ((bin < ERROR_BINS - 1) && (error > std::abs(errorBinLimits()[bin] / 100.0 * actual)))
+        {
+            bin++;
+        }
+        m_errorBins[bin]++;
+        return true;
+    }
+
+    // Adds the frames of another score (e.g., of another recording).
+    void merge(const SteeringScore &other)
+    {
+        m_frames += other.m_frames;
+        m_correct += other.m_correct;
+        for (std::size_t i = 0; i < ERROR_BINS; i++)
+        {
+            m_errorBins[i] += other.m_errorBins[i];
+        }
+    }
+
+    // Number of frames with non-zero ground steering
+    int frames() const { return m_frames; }
+    // Number of those within 25% of the ground steering
+    int correct() const { return m_correct; }
+    // % of frames within 25% of the actual steering value
+    double percentCorrect() const
+    {
+        return (0 == m_frames) ? 0.0 : (static_cast<double>(m_correct) / m_frames * 100.0);
+    }
+
+    // Frames per relative error bin (see errorBinLimits())
+    const std::array<int, ERROR_BINS> &errorBins() const { return m_errorBins; }
+
+private:
+    int m_frames{0};
+    int m_correct{0};
+    std::array<int, ERROR_BINS> m_errorBins{};
+};
+
+#endif
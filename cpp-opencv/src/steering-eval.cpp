@@ -0,0 +1,362 @@
+/* Title: Steering Evaluation - replays recordings through the steering algorithm without a running system
+ * Authors: Nasit Vurgun, Sam Hardingham, Kai Rowley, Daniel van den Heuvel
+ * Institution: University of Gothenburg, Sweden
+ * Course: DIT638/DIT639 (2024), taught by Prof. Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Include the single-file, header-only middleware libcluon for reading the recordings
+#include "cluon-complete.hpp"
+// Include the OpenDLV Standard Message Set for the recorded messages
+#include "opendlv-standard-message-set.hpp"
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include "cone-detection.hpp"
+#include "cone-mask.hpp"
+#include "h264-decoder.hpp"
+#include "prefilter.hpp"
+#include "sensor-history.hpp"
+#include "sensor-mailbox.hpp"
+#include "steering-core.hpp"
+#include "worker-pool.hpp"
+
+#include <algorithm> // For std::sort, std::stable_sort
+#include <array>     // For the per-colour searches
+#include <chrono>    // For timing
+#include <fstream>   // For the plotting data
+#include <iomanip>   // For formatting the report
+#include <iostream>  // For printing the report
+#include <string>    // For strings
+#include <thread>    // For std::thread::hardware_concurrency
+#include <vector>    // For the list of recordings
+
+#include <dirent.h>   // For listing directories
+#include <sys/stat.h> // For file sizes
+
+// Settings of the steering algorithm used for all recordings.
+struct EvaluationSettings
+{
+    PrefilterMode prefilter;
+    double sigma;
+    Alignment alignment;
+    std::string csvDirectory; // plotting data per recording if not empty
+};
+
+// Outcome of replaying one recording.
+struct Evaluation
+{
+    std::string file;
+    bool opened;
+    int images;       // h264 ImageReadings in the recording
+    int frames;       // images that were decoded and processed
+    SteeringScore score;
+    double seconds;   // wall-clock time
+};
+
+// File name without directory and extension.
+std::string baseName(const std::string &file)
+{
+    const std::size_t slash = file.find_last_of('/');
+    const std::string name = (std::string::npos == slash) ? file : file.substr(slash + 1);
+    const std::size_t dot = name.find_last_of('.');
+    return (std::string::npos == dot) ? name : name.substr(0, dot);
+}
+
+// Size of file in bytes, or -1 if it cannot be accessed.
+int64_t fileSize(const std::string &file)
+{
+    struct stat info;
+    return (0 == ::stat(file.c_str(), &info)) ? static_cast<int64_t>(info.st_size) : -1;
+}
+
+// Appends path if it is a file, or all .rec files in it (sorted by name) if it is a directory.
+void addRecordings(const std::string &path, std::vector<std::string> &recordings)
+{
+    DIR *directory = ::opendir(path.c_str());
+    if (nullptr == directory)
+    {
+        recordings.push_back(path);
+        return;
+    }
+    std::vector<std::string> files;
+    for (struct dirent *entry = ::readdir(directory); nullptr != entry; entry = ::readdir(directory))
+    {
+        const std::string name{entry->d_name};
+        if ((name.size() > 4) && (0 == name.compare(name.size() - 4, 4, ".rec")))
+        {
+            files.push_back(path + "/" + name);
+        }
+    }
+    ::closedir(directory);
+    std::sort(files.begin(), files.end());
+    recordings.insert(recordings.end(), files.begin(), files.end());
+}
+
+// Replays all envelopes of file in recording order and as fast as possible: the sensor readings
+// are collected like in the microservice and every image runs through the same detection and
+// steering code. The ground truth is the latest GroundSteeringRequest at the time of the image.
+Evaluation evaluate(const std::string &file, const EvaluationSettings &settings)
+{
+    Evaluation evaluation{file, false, 0, 0, SteeringScore(), 0.0};
+    const auto start = std::chrono::steady_clock::now();
+
+    // Only the messages used below are read from the recording.
+    cluon::EnvelopeFilter filter;
+    filter.allow(opendlv::proxy::ImageReading::ID())
+        .allow(opendlv::proxy::GroundSteeringRequest::ID())
+        .allow(opendlv::proxy::AngularVelocityReading::ID())
+        .allow(opendlv::proxy::DistanceReading::ID(), 0);
+    cluon::Player player(file, false, false, filter);
+    H264Decoder decoder;
+    if (!player.hasMoreData() || !decoder.valid())
+    {
+        return evaluation;
+    }
+    evaluation.opened = true;
+
+    std::ofstream csv;
+    if (!settings.csvDirectory.empty())
+    {
+        csv.open(settings.csvDirectory + "/" + baseName(file) + ".csv");
+    }
+
+    Prefilter prefilter{settings.prefilter, settings.sigma};
+    cv::Mat frame, cropped, blurred, yellowMask, blueMask;
+    std::array<ConeSearch, 2> searches{{{&yellowMask, BlobDetector(STEERING_ROI.height, STEERING_ROI.width), 0},
+                                        {&blueMask, BlobDetector(STEERING_ROI.height, STEERING_ROI.width), 0}}};
+    SteeringCore steeringCore;
+
+    SensorMailbox<float> groundSteering;
+    SensorHistory<64> distance;
+    SensorHistory<64> angularVelocity;
+
+    while (player.hasMoreData())
+    {
+        std::pair<bool, cluon::data::Envelope> next = player.getNextEnvelopeToBeReplayed();
+        if (!next.first)
+        {
+            break;
+        }
+        cluon::data::Envelope &env = next.second;
+        const int64_t sampleTime = cluon::time::toMicroseconds(env.sampleTimeStamp());
+
+        if (opendlv::proxy::GroundSteeringRequest::ID() == env.dataType())
+        {
+            groundSteering.store(cluon::extractMessage<opendlv::proxy::GroundSteeringRequest>(std::move(env)).groundSteering(), sampleTime);
+        }
+        else if ((opendlv::proxy::DistanceReading::ID() == env.dataType()) && (0 == env.senderStamp()))
+        {
+            distance.append(sampleTime, cluon::extractMessage<opendlv::proxy::DistanceReading>(std::move(env)).distance());
+        }
+        else if (opendlv::proxy::AngularVelocityReading::ID() == env.dataType())
+        {
+            angularVelocity.append(sampleTime, cluon::extractMessage<opendlv::proxy::AngularVelocityReading>(std::move(env)).angularVelocityZ());
+        }
+        else if (opendlv::proxy::ImageReading::ID() == env.dataType())
+        {
+            opendlv::proxy::ImageReading image = cluon::extractMessage<opendlv::proxy::ImageReading>(std::move(env));
+            if ("h264" != image.fourcc())
+            {
+                continue;
+            }
+            evaluation.images++;
+            if (!decoder.decode(image.data(), frame) || (frame.cols < STEERING_ROI.x + STEERING_ROI.width) || (frame.rows < STEERING_ROI.y + STEERING_ROI.height))
+            {
+                continue;
+            }
+            evaluation.frames++;
+
+            // Same stages as in the frame loop of the microservice; the ROI is copied
+            // like in the frame ring so that the blur does not read pixels outside of it
+            frame(STEERING_ROI).copyTo(cropped);
+            prefilter.apply(cropped, blurred);
+            fusedConeMasks(blurred, YELLOW_MIN, YELLOW_MAX, BLUE_MIN, BLUE_MAX, yellowMask, blueMask);
+            for (ConeSearch &search : searches)
+            {
+                search.run(1);
+            }
+            ConeObservation cones{false, false, cv::Point(0, 0), cv::Point(0, 0)};
+            if (searches[0].cones > 0)
+            {
+                cones.yellow = true;
+                cones.midYellow = coneMidpoint(searches[0].largest().rect, DETECTION_THRESHOLD);
+            }
+            if (searches[1].cones > 0)
+            {
+                cones.blue = true;
+                cones.midBlue = coneMidpoint(searches[1].largest().rect, DETECTION_THRESHOLD);
+            }
+
+            const AlignedValue alignedDistance = distance.at(sampleTime, settings.alignment);
+            const AlignedValue alignedAngularVelocity = angularVelocity.at(sampleTime, settings.alignment);
+            const double steeringWheelAngle = steeringCore.update(cones, alignedAngularVelocity.valid ? alignedAngularVelocity.value : 0.0,
+                                                                  alignedDistance.valid ? alignedDistance.value : 0.0);
+            const double actualSteering = groundSteering.value();
+            evaluation.score.add(steeringWheelAngle, actualSteering);
+
+            if (csv.is_open())
+            {
+                csv << sampleTime << "," << steeringWheelAngle << "," << actualSteering << "\n";
+            }
+        }
+    }
+
+    evaluation.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return evaluation;
+}
+
+// Frames per relative error bin as a table row: "<=5%  <=10% ... >100%".
+void printErrorHistogram(std::ostream &out, const SteeringScore &score)
+{
+    const auto &limits = SteeringScore::errorBinLimits();
+    for (std::size_t i = 0; i < SteeringScore::ERROR_BINS; i++)
+    {
+        const std::string label = (i < limits.size()) ? ("<=" + std::to_string(limits[i]) + "%") : (">" + std::to_string(limits.back()) + "%");
+        out << std::setw(8) << label;
+    }
+    out << std::endl;
+    for (std::size_t i = 0; i < SteeringScore::ERROR_BINS; i++)
+    {
+        out << std::setw(8) << score.errorBins()[i];
+    }
+    out << std::endl;
+}
+
+void printEvaluation(std::ostream &out, const Evaluation &evaluation)
+{
+    out << evaluation.file << ": ";
+    if (!evaluation.opened)
+    {
+        out << "could not be read" << std::endl;
+        return;
+    }
+    out << evaluation.frames << "/" << evaluation.images << " frames, " << evaluation.score.frames() << " with steering, "
+        << evaluation.score.correct() << " within 25% (";
+    if (evaluation.score.frames() > 0)
+    {
+        out << std::fixed << std::setprecision(2) << evaluation.score.percentCorrect() << "%";
+    }
+    else
+    {
+        out << "n/a";
+    }
+    out << ") in " << std::fixed << std::setprecision(2) << evaluation.seconds << " s" << std::endl;
+    printErrorHistogram(out, evaluation.score);
+}
+
+int32_t main(int32_t argc, char **argv)
+{
+    auto commandlineArguments = cluon::getCommandlineArguments(argc, argv);
+    std::vector<std::string> recordings;
+    for (int32_t i = 1; i < argc; i++)
+    {
+        const std::string argument{argv[i]};
+        if (0 != argument.compare(0, 2, "--"))
+        {
+            addRecordings(argument, recordings);
+        }
+    }
+
+    EvaluationSettings settings{PrefilterMode::LEGACY, DEFAULT_PREFILTER_SIGMA, Alignment::INTERPOLATE, ""};
+    bool validSettings{true};
+    if ((commandlineArguments.count("prefilter") != 0) && !parsePrefilterMode(commandlineArguments["prefilter"], settings.prefilter))
+    {
+        std::cerr << argv[0] << ": Unknown prefilter '" << commandlineArguments["prefilter"] << "'." << std::endl;
+        validSettings = false;
+    }
+    if ((commandlineArguments.count("align") != 0) && !parseAlignment(commandlineArguments["align"], settings.alignment))
+    {
+        std::cerr << argv[0] << ": Unknown alignment '" << commandlineArguments["align"] << "'." << std::endl;
+        validSettings = false;
+    }
+    if (commandlineArguments.count("sigma") != 0)
+    {
+        settings.sigma = std::stod(commandlineArguments["sigma"]);
+    }
+    if (commandlineArguments.count("csv") != 0)
+    {
+        settings.csvDirectory = commandlineArguments["csv"];
+    }
+    const std::size_t JOBS{(commandlineArguments.count("jobs") != 0) ? static_cast<std::size_t>(std::max(1, std::stoi(commandlineArguments["jobs"])))
+                                                                     : std::max<std::size_t>(1, std::thread::hardware_concurrency())};
+
+    if ((0 != commandlineArguments.count("help")) || recordings.empty() || !validSettings)
+    {
+        std::cerr << argv[0] << " replays recordings through the steering algorithm as fast as possible and reports how many frames are within 25% of the ground steering." << std::endl;
+        std::cerr << "Usage:   " << argv[0] << " [--jobs=<n>] [--prefilter=<mode>] [--sigma=<sigma>] [--align=<mode>] [--csv=<directory>] <recording.rec|directory> [...]" << std::endl;
+        std::cerr << "         --jobs:      number of recordings replayed in parallel (default: number of CPUs)" << std::endl;
+        std::cerr << "         --prefilter: blurring stage: legacy (default), auto, box, pyramid, or none" << std::endl;
+        std::cerr << "         --sigma:     sigma of the blurring stage (default: 2.5)" << std::endl;
+        std::cerr << "         --align:     matching of the sensor readings to the frame time: interpolate (default), nearest, or latest" << std::endl;
+        std::cerr << "         --csv:       directory to write <recording>.csv with time stamp, computed and actual steering per frame" << std::endl;
+        std::cerr << "         Directories are searched for .rec files." << std::endl;
+        std::cerr << "Example: " << argv[0] << " --jobs=8 recordings" << std::endl;
+        return 1;
+    }
+
+    // Largest recordings first, so that the long replays do not end up last on a single thread.
+    std::vector<std::size_t> order(recordings.size());
+    for (std::size_t i = 0; i < order.size(); i++)
+    {
+        order[i] = i;
+    }
+    std::vector<int64_t> sizes(recordings.size());
+    for (std::size_t i = 0; i < recordings.size(); i++)
+    {
+        sizes[i] = fileSize(recordings[i]);
+    }
+    std::stable_sort(order.begin(), order.end(), [&sizes](std::size_t a, std::size_t b) { return sizes[a] > sizes[b]; });
+
+    // Each job owns its player, decoder and steering core; results are stored per recording.
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<Evaluation> evaluations(recordings.size(), Evaluation{"", false, 0, 0, SteeringScore(), 0.0});
+    runWorkStealing(order.size(), JOBS, [&order, &recordings, &settings, &evaluations](std::size_t i)
+    {
+        evaluations[order[i]] = evaluate(recordings[order[i]], settings);
+    });
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    int32_t retCode{0};
+    SteeringScore overall;
+    int frames{0};
+    for (const Evaluation &evaluation : evaluations)
+    {
+        printEvaluation(std::cout, evaluation);
+        if (!evaluation.opened)
+        {
+            retCode = 1;
+        }
+        overall.merge(evaluation.score);
+        frames += evaluation.frames;
+    }
+
+    std::cout << std::endl
+              << "overall: " << recordings.size() << " recordings, " << frames << " frames, " << overall.frames() << " with steering, "
+              << overall.correct() << " within 25% (";
+    if (overall.frames() > 0)
+    {
+        std::cout << std::fixed << std::setprecision(2) << overall.percentCorrect() << "%";
+    }
+    else
+    {
+        std::cout << "n/a";
+    }
+    std::cout << ") in " << std::fixed << std::setprecision(2) << seconds << " s on " << std::min(JOBS, recordings.size()) << " threads" << std::endl;
+    std::cout << "relative error of the frames with steering:" << std::endl;
+    printErrorHistogram(std::cout, overall);
+    return retCode;
+}
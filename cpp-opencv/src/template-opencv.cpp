@@ -24,6 +24,31 @@
 #include "cluon-complete.hpp"
 // Include the OpenDLV Standard Message Set that contains messages that are usually exchanged for automotive or robotic applications
 #include "opendlv-standard-message-set.hpp"
+// Include the messages specific to this microservice (e.g., pipeline latency reports)
+#include "steering-message-set.hpp"
+// Pre-allocated ring of ROI snapshots taken from the shared memory
+#include "frame-ring.hpp"
+// Frames of the producer from its frame ring or its single-slot shared memory
+#include "frame-source.hpp"
+// Configurable blurring stage
+#include "prefilter.hpp"
+// Largest cone per colour mask
+#include "cone-detection.hpp"
+// Fused BGR -> HSV -> threshold kernel
+#include "cone-mask.hpp"
+// Persistent threads for the per-colour detection
+#include "worker-pool.hpp"
+// Per-stage latency histograms of the frame loop
+#include "latency-stats.hpp"
+
+// Lock-free latest-value mailboxes for the sensor inputs
+#include "sensor-mailbox.hpp"
+
+// Time stamped sensor samples for matching the inputs to the frame time
+#include "sensor-history.hpp"
+
+// Steering angle computation and ground truth comparison (shared with steering-eval)
+#include "steering-core.hpp"
 
 // Include the GUI and image processing header files from OpenCV
 #include <opencv2/highgui/highgui.hpp>
@@ -36,6 +61,10 @@
 #include <string>   // For strings
 #include <cmath>    // For std::abs, math
 #include <iostream> // For std::ostringstream
+#include <array>    // For the per-colour searches
+#include <algorithm> // For std::max
+#include <map>      // For the command line arguments
+#include <stdexcept> // For the errors of std::stoll
 
 // Preprocessor directives - define production or test mode - in test mode, it writes steering data to a csv file in /tmp/ folder
 #define PRODUCTION
@@ -44,47 +73,35 @@
 #endif
 
 // GLOBAL VARIABLES:
-// OpenCV data structure to hold an image.
-cv::Mat croppedImg, blurredCroppedImg, hsvImage;
+// OpenCV data structure to hold an image (croppedImg refers to the current slot of the frame ring).
+cv::Mat croppedImg, blurredCroppedImg;
+// Binary masks of the cone colours, reused across frames.
+cv::Mat yellowMask, blueMask;
 
 // Cropping rectangle definition of the shared memory img
-cv::Rect roi = cv::Rect(0, 255, 640, 144);
+cv::Rect roi = STEERING_ROI;
 
-// Define HSV color ranges for detecting yellow, blue, and red cones:
-// Each pair of Scalars defines the min and max H, S, and V values.
-cv::Scalar yellowMin = cv::Scalar(20, 60, 70);
-cv::Scalar yellowMax = cv::Scalar(40, 200, 200);
-cv::Scalar blueMin = cv::Scalar(100, 50, 30);
-cv::Scalar blueMax = cv::Scalar(120, 255, 253);
-
-// Sensor variables
+// Sensor variables (aligned to the time stamp of the current frame)
 double distanceUS = 0.0;       // Ultrasound sensor reading
 double angularVelocityZ = 0.0; // Angular velocity Z sensor reading
 
-// Object Detection Variables
-int yellowCone = 0; // yellow cone found
-int blueCone = 0;   // blue cone found
-
 // Steering Wheel Angle Related Variables
 double steeringWheelAngle = 0.0; // calculated steering wheel angle
 double actual_steering = 0.0;    // ground truth
-double error = 0.0;              // absolute error
 
-// Clockwise vs Counterclockwise counter
-int CW = 0; // positive if clockwise
-
-// Position of Cones - used in Steering Calculation
-cv::Point midYellow(0, 0); // center of rect containing yellow cone
-cv::Point midBlue(0, 0);   // center of rect containing blue cone
+// Steering calculation; keeps the cone positions and the CW vs CCW counter across frames
+SteeringCore steeringCore;
 
 // Comparing Calculated Steering Wheel Angle with Ground Truth
-int totalFrames = 0;         // number of non-zero steering frames
-int totalCorrect = 0;        // number of correct steering frames
-double percentCorrect = 0.0; // % of frames within 25% of actual steering value
+SteeringScore steeringScore;
+
+// Upper bounds of --buffers and --workers
+const uint32_t MAX_BUFFERS = 64;
+const uint32_t MAX_WORKERS = 64;
 
 // Function declarations
-double steering_function(double X); // Steering Function
-cv::Point processContour(const std::vector<cv::Point> &contour, cv::Mat &image, const cv::Scalar &color, int detection_threshold);
+cv::Point processCone(const cv::Rect &bounding_rect, cv::Mat &image, const cv::Scalar &color, int detection_threshold);
+bool parseCount(std::map<std::string, std::string> &commandlineArguments, const std::string &key, uint32_t min, uint32_t max, uint32_t &value);
 
 #ifdef TEST
 // Utilities (mainly for testing)
@@ -110,17 +127,41 @@ int32_t main(int32_t argc, char **argv)
 
     // Parse the command line parameters as we require the user to specify some mandatory information on startup.
     auto commandlineArguments = cluon::getCommandlineArguments(argc, argv);
+    uint32_t buffers{2};
+    const bool VALID_BUFFERS{parseCount(commandlineArguments, "buffers", 1, MAX_BUFFERS, buffers)};
+    uint32_t workers{0};
+    const bool VALID_WORKERS{parseCount(commandlineArguments, "workers", 0, MAX_WORKERS, workers)};
     if ((0 == commandlineArguments.count("cid")) ||
         (0 == commandlineArguments.count("name")) ||
         (0 == commandlineArguments.count("width")) ||
-        (0 == commandlineArguments.count("height")))
+        (0 == commandlineArguments.count("height")) ||
+        !VALID_BUFFERS || !VALID_WORKERS)
     {
+        if (!VALID_BUFFERS)
+        {
+            std::cerr << argv[0] << ": Invalid --buffers '" << commandlineArguments["buffers"] << "'; expected 1 to " << MAX_BUFFERS << "." << std::endl;
+        }
+        if (!VALID_WORKERS)
+        {
+            std::cerr << argv[0] << ": Invalid --workers '" << commandlineArguments["workers"] << "'; expected 0 to " << MAX_WORKERS << "." << std::endl;
+        }
         std::cerr << argv[0] << " attaches to a shared memory area containing an ARGB image." << std::endl;
         std::cerr << "Usage:   " << argv[0] << " --cid=<OD4 session> --name=<name of shared memory area> [--verbose]" << std::endl;
         std::cerr << "         --cid:    CID of the OD4Session to send and receive messages" << std::endl;
-        std::cerr << "         --name:   name of the shared memory area to attach" << std::endl;
+        std::cerr << "         --name:   name of the shared memory area to attach (the producer's frame ring if there is one)" << std::endl;
         std::cerr << "         --width:  width of the frame" << std::endl;
         std::cerr << "         --height: height of the frame" << std::endl;
+        std::cerr << "         --buffers: number of pre-allocated ROI snapshot buffers (default: 2, at most 64)" << std::endl;
+        std::cerr << "         --prefilter: blurring stage: legacy (101x101 Gaussian, default), auto, box, pyramid, or none" << std::endl;
+        std::cerr << "         --sigma:  sigma of the blurring stage (default: 2.5)" << std::endl;
+        std::cerr << "         --workers: number of worker threads for the per-colour detection (default: 1, 0 = sequential, at most 64)" << std::endl;
+        std::cerr << "         --affinity: comma-separated CPUs; the first pins the frame loop, the following ones the workers" << std::endl;
+        std::cerr << "         --cones:  number of largest cones tracked per colour (default: 1; the largest one is used for steering)" << std::endl;
+        std::cerr << "         --stats:  interval in seconds for reporting per-stage latencies and frame drops on stderr and as steering.PipelineLatency/FrameDrops (default: 10, 0 = off)" << std::endl;
+        std::cerr << "         --deadline: budget in ms from frame capture to publishing the GroundSteeringRequest (default: 50)" << std::endl;
+        std::cerr << "         --sender-stamp: senderStamp of the published GroundSteeringRequest (default: 0)" << std::endl;
+        std::cerr << "         --align:  matching of the sensor readings to the frame time: interpolate (default), nearest, or latest" << std::endl;
+        std::cerr << "         --handshake: process every frame exactly once; the producer waits until each frame is done (requires a producer with frame sequence numbers)" << std::endl;
         std::cerr << "Example: " << argv[0] << " --cid=253 --name=img --width=640 --height=480 --verbose" << std::endl;
     }
     else
@@ -130,59 +171,124 @@ int32_t main(int32_t argc, char **argv)
         const uint32_t WIDTH{static_cast<uint32_t>(std::stoi(commandlineArguments["width"]))};
         const uint32_t HEIGHT{static_cast<uint32_t>(std::stoi(commandlineArguments["height"]))};
         const bool VERBOSE{commandlineArguments.count("verbose") != 0};
+        const uint32_t BUFFERS{buffers};
+
+        // Snapshot buffers for the ROI, allocated once so that no memory is allocated while the shared memory is locked
+        FrameRing frameRing{BUFFERS, roi.size(), CV_8UC4};
+        LockHoldTimer lockHoldTimer;
 
-        // Attach to the shared memory.
-        std::unique_ptr<cluon::SharedMemory> sharedMemory{new cluon::SharedMemory{NAME}};
-        if (sharedMemory && sharedMemory->valid())
+        // Blurring stage selected from the command line
+        PrefilterMode prefilterMode{PrefilterMode::LEGACY};
+        if ((commandlineArguments.count("prefilter") != 0) && !parsePrefilterMode(commandlineArguments["prefilter"], prefilterMode))
         {
-            std::clog << argv[0] << ": Attached to shared memory '" << sharedMemory->name() << " (" << sharedMemory->size() << " bytes)." << std::endl;
+            std::cerr << argv[0] << ": Unknown prefilter '" << commandlineArguments["prefilter"] << "'." << std::endl;
+            return retCode;
+        }
+        const double SIGMA{(commandlineArguments.count("sigma") != 0) ? std::stod(commandlineArguments["sigma"]) : DEFAULT_PREFILTER_SIGMA};
+        Prefilter prefilter{prefilterMode, SIGMA};
+
+        // Alignment of the angular velocity and ultrasound readings with the frame time stamp
+        Alignment alignment{Alignment::INTERPOLATE};
+        if ((commandlineArguments.count("align") != 0) && !parseAlignment(commandlineArguments["align"], alignment))
+        {
+            std::cerr << argv[0] << ": Unknown alignment '" << commandlineArguments["align"] << "'." << std::endl;
+            return retCode;
+        }
+
+        // One search per colour; the colours are processed concurrently by the worker pool and the frame loop thread.
+        // Further colours (e.g. red) are added here together with the mask they are searched in.
+        std::array<ConeSearch, 2> coneSearches{{{&yellowMask, BlobDetector(roi.height, roi.width), 0}, {&blueMask, BlobDetector(roi.height, roi.width), 0}}};
+        const std::size_t YELLOW{0};
+        const std::size_t BLUE{1};
+        const std::size_t CONES{(commandlineArguments.count("cones") != 0) ? static_cast<std::size_t>(std::max(1, std::stoi(commandlineArguments["cones"]))) : 1};
+        auto searchCone = [&coneSearches, CONES](std::size_t i)
+        {
+            coneSearches[i].run(CONES);
+        };
+        const std::function<void(std::size_t)> searchConeJob{searchCone};
+
+        // Thread affinity: first CPU for this thread, the remaining ones for the workers
+        std::vector<int> cpus;
+        if (commandlineArguments.count("affinity") != 0)
+        {
+            cpus = parseCpuList(commandlineArguments["affinity"]);
+        }
+        if (!cpus.empty() && !pinCurrentThread(cpus.front()))
+        {
+            std::cerr << argv[0] << ": Could not pin the frame loop to CPU " << cpus.front() << "." << std::endl;
+        }
+        const std::size_t WORKERS{(commandlineArguments.count("workers") != 0) ? static_cast<std::size_t>(workers) : coneSearches.size() - 1};
+        WorkerPool detectionPool{WORKERS, cpus.empty() ? cpus : std::vector<int>(cpus.begin() + 1, cpus.end())};
+
+        // Per-stage latencies, reported every STATS_INTERVAL
+        const std::chrono::milliseconds STATS_INTERVAL{static_cast<int64_t>(1000.0 * ((commandlineArguments.count("stats") != 0) ? std::stod(commandlineArguments["stats"]) : 10.0))};
+        PipelineTimer pipelineTimer;
+
+        // Frame capture to publish latency of the steering requests
+        const double DEADLINE_MS{(commandlineArguments.count("deadline") != 0) ? std::stod(commandlineArguments["deadline"]) : 50.0};
+        DeadlineMonitor deadlineMonitor{std::chrono::microseconds{static_cast<int64_t>(1000.0 * DEADLINE_MS)}};
+        const uint32_t SENDER_STAMP{(commandlineArguments.count("sender-stamp") != 0) ? static_cast<uint32_t>(std::stoul(commandlineArguments["sender-stamp"])) : 0};
+
+        // Lock-step with the producer for repeatable runs; otherwise dropped and late frames are counted
+        const bool HANDSHAKE{commandlineArguments.count("handshake") != 0};
+        bool handshakeSuspended{false};
+        FrameCounter frameCounter;
+
+        // Attach to the frame ring or the shared memory.
+        FrameSource frameSource{NAME};
+        if (frameSource.valid())
+        {
+            if (frameSource.idleRingSkipped())
+            {
+                std::clog << argv[0] << ": Ignoring the frame ring of '" << NAME << "' as no frame was written to it (left behind by a previous producer?)." << std::endl;
+            }
+            std::clog << argv[0] << ": Attached to " << (frameSource.isRing() ? "frame ring '" : "shared memory '") << frameSource.name() << " (" << frameSource.size() << " bytes)." << std::endl;
+            std::clog << argv[0] << ": Using '" << prefilterName(prefilter.mode()) << "' prefilter and " << conemask::isaName(conemask::detectIsa()) << " cone masks." << std::endl;
+            if (HANDSHAKE && !frameSource.setHandshake(true))
+            {
+                std::cerr << argv[0] << ": The producer of '" << frameSource.name() << "' does not support the handshake (it writes a frame ring or has no frame sequence numbers)." << std::endl;
+                return retCode;
+            }
 
             // Interface to a running OpenDaVINCI session where network messages are exchanged.
             // The instance od4 allows you to send and receive messages.
             cluon::OD4Session od4{static_cast<uint16_t>(std::stoi(commandlineArguments["cid"]))};
 
-            opendlv::proxy::GroundSteeringRequest gsr;
-            std::mutex gsrMutex;
-            std::string timeStampGSR;
-            auto onGroundSteeringRequest = [&gsr, &gsrMutex, &timeStampGSR](cluon::data::Envelope &&env)
+            // The callbacks run in the OD4 receiver thread; they only store the latest value with its
+            // sample time stamp, the frame loop reads consistent snapshots without taking a lock.
+            SensorMailbox<float> groundSteering;
+            auto onGroundSteeringRequest = [&groundSteering](cluon::data::Envelope &&env)
             {
                 // The envelope data structure provide further details, such as sampleTimePoint as shown in this test case:
                 // https://github.com/chrberger/libcluon/blob/master/libcluon/testsuites/TestEnvelopeConverter.cpp#L31-L40
-                std::lock_guard<std::mutex> lck(gsrMutex);
-
-                // locks twice, to get image, to get data
-                // CHANGE HERE
-                gsr = cluon::extractMessage<opendlv::proxy::GroundSteeringRequest>(std::move(env));
-                // std::cout << "lambda: groundSteering = " << gsr.groundSteering() << std::endl;
+                const int64_t sampleTime = cluon::time::toMicroseconds(env.sampleTimeStamp());
+                opendlv::proxy::GroundSteeringRequest gsr = cluon::extractMessage<opendlv::proxy::GroundSteeringRequest>(std::move(env));
+                groundSteering.store(gsr.groundSteering(), sampleTime);
             };
 
             od4.dataTrigger(opendlv::proxy::GroundSteeringRequest::ID(), onGroundSteeringRequest);
 
-            // Ultrasound Sensor Readings
-            opendlv::proxy::DistanceReading ultrasound;
-            std::mutex ultrasoundMutex;
-            std::string timeStampUS;
-            auto onDistanceReading = [&ultrasound, &ultrasoundMutex, &timeStampUS](cluon::data::Envelope &&env)
+            // Ultrasound Sensor Readings (front sensor only); the last samples are kept for matching them to the frame time
+            SensorHistory<64> distance;
+            auto onDistanceReading = [&distance](cluon::data::Envelope &&env)
             {
-                std::lock_guard<std::mutex> lck(ultrasoundMutex);
-                ultrasound = cluon::extractMessage<opendlv::proxy::DistanceReading>(std::move(env));
                 if (env.senderStamp() == 0)
                 {
-                    distanceUS = ultrasound.distance();
+                    const int64_t sampleTime = cluon::time::toMicroseconds(env.sampleTimeStamp());
+                    opendlv::proxy::DistanceReading ultrasound = cluon::extractMessage<opendlv::proxy::DistanceReading>(std::move(env));
+                    distance.append(sampleTime, ultrasound.distance());
                 }
             };
 
             od4.dataTrigger(opendlv::proxy::DistanceReading::ID(), onDistanceReading);
 
             // Angular Velocity Sensor Readings
-            opendlv::proxy::AngularVelocityReading angularVelocity;
-            std::mutex angularMutex;
-            std::string timeStampAngularVelocity;
-            auto onAngularVelocityReading = [&angularVelocity, &angularMutex, &timeStampAngularVelocity](cluon::data::Envelope &&env)
+            SensorHistory<64> angularVelocity;
+            auto onAngularVelocityReading = [&angularVelocity](cluon::data::Envelope &&env)
             {
-                std::lock_guard<std::mutex> lck(angularMutex);
-                angularVelocity = cluon::extractMessage<opendlv::proxy::AngularVelocityReading>(std::move(env));
-                angularVelocityZ = angularVelocity.angularVelocityZ();
+                const int64_t sampleTime = cluon::time::toMicroseconds(env.sampleTimeStamp());
+                opendlv::proxy::AngularVelocityReading reading = cluon::extractMessage<opendlv::proxy::AngularVelocityReading>(std::move(env));
+                angularVelocity.append(sampleTime, reading.angularVelocityZ());
             };
 
             od4.dataTrigger(opendlv::proxy::AngularVelocityReading::ID(), onAngularVelocityReading);
@@ -191,191 +297,132 @@ int32_t main(int32_t argc, char **argv)
             while (od4.isRunning())
             {
 
-                // Wait for a notification of a new frame.
-                sharedMemory->wait();
+                // Wait for a new frame; with frame sequence numbers, the wait polls them and times out to check od4.
+                pipelineTimer.begin();
+                if (!frameSource.wait(std::chrono::milliseconds(100)))
+                {
+                    continue;
+                }
+                pipelineTimer.mark(Stage::WAIT);
 
-                // Lock the shared memory.
-                sharedMemory->lock();
+                // Take the ROI snapshot and the time stamp; the shared memory is locked only meanwhile (a frame ring is not locked at all).
+                lockHoldTimer.start();
+                std::pair<bool, cluon::data::TimeStamp> tStamp = frameSource.take([&](const char *data)
                 {
-                    // Copy the pixels from the shared memory into our own data structure.
-                    cv::Mat wrapped(HEIGHT, WIDTH, CV_8UC4, sharedMemory->data());
+                    lockHoldTimer.acquired();
+
+                    // Wrap the pixels in the shared memory without copying them.
+                    cv::Mat wrapped(HEIGHT, WIDTH, CV_8UC4, const_cast<char *>(data));
 
-                    // Crop image here
-                    croppedImg = wrapped(roi).clone();
+                    // Copy only the cropped region into the next pre-allocated buffer
+                    croppedImg = frameRing.store(wrapped, roi);
+                });
+                lockHoldTimer.stop();
+                if (!tStamp.first)
+                {
+                    continue;
                 }
-                // Get the time for each image
-                std::pair<bool, cluon::data::TimeStamp> tStamp = sharedMemory->getTimeStamp();
-                // Convert the time to microseconds
+
+                // Convert the time to microseconds (outside of the lock)
                 std::string timeStamp = std::to_string(cluon::time::toMicroseconds(tStamp.second));
 
-                sharedMemory->unlock();
+                if (VERBOSE)
+                {
+                    std::clog << "lock-wait: " << lockHoldTimer.lastWait() << " us (mean: " << lockHoldTimer.meanWait() << " us, max: " << lockHoldTimer.maxWait() << " us), "
+                              << "lock-hold: " << lockHoldTimer.last() << " us (mean: " << lockHoldTimer.mean() << " us, max: " << lockHoldTimer.max() << " us)" << std::endl;
+                }
+                pipelineTimer.mark(Stage::LOCK_COPY);
 
                 //  Blurring
-                cv::GaussianBlur(croppedImg, blurredCroppedImg, cv::Size(101, 101), 2.5);
+                prefilter.apply(croppedImg, blurredCroppedImg);
+                pipelineTimer.mark(Stage::BLUR);
 
-                // Convert the copied image into hsv color space
-                cv::cvtColor(blurredCroppedImg, hsvImage, cv::COLOR_BGR2HSV);
-
-                // Create masks isolating yellow, blue, and red hues within their respective ranges,
-                // and find contours to store outlines of cones of each color.
-                cv::Mat yellowMask;
-                cv::inRange(hsvImage, yellowMin, yellowMax, yellowMask);
-                std::vector<std::vector<cv::Point>> yellowContours;
-                cv::findContours(yellowMask, yellowContours, cv::RETR_TREE, cv::CHAIN_APPROX_SIMPLE);
-
-                cv::Mat blueMask;
-                cv::inRange(hsvImage, blueMin, blueMax, blueMask);
-                std::vector<std::vector<cv::Point>> blueContours;
-                cv::findContours(blueMask, blueContours, cv::RETR_TREE, cv::CHAIN_APPROX_SIMPLE);
-
-                // Initialize vectors to save contours from image detection
-                std::vector<cv::Moments> muYellow(yellowContours.size());
-                std::vector<cv::Moments> muBlue(blueContours.size());
+                // Create masks isolating yellow and blue hues within their respective HSV ranges in a single pass
+                // over the image; the HSV conversion happens per pixel inside the kernel (same results as cvtColor + inRange).
+                fusedConeMasks(blurredCroppedImg, YELLOW_MIN, YELLOW_MAX, BLUE_MIN, BLUE_MAX, yellowMask, blueMask);
+                pipelineTimer.mark(Stage::MASKS);
 
                 // Print timestamp
                 std::string messageTimeStamp = +"ts: " + timeStamp + ";";
                 cv::putText(blurredCroppedImg, messageTimeStamp, cv::Point(5, 10), cv::FONT_HERSHEY_SIMPLEX, 0.2, cv::Scalar(255, 255, 255), 1);
 
                 /****************** OBJECT DETECTION **********************************************/
-                int detection_threshold = 10;
-
-                // Detect yellow cones
-                int max_yellow_contour_area = 0;
-                int index_yellow = -1;
-                for (size_t i = 0; i < yellowContours.size(); i++)
-                {
-                    cv::Rect bounding_rect_yellow = cv::boundingRect(yellowContours[i]);
-                    int area = bounding_rect_yellow.width * bounding_rect_yellow.height;
-                    // Find maximum area contour
-                    if (area > max_yellow_contour_area)
-                    {
-                        max_yellow_contour_area = area;
-                        index_yellow = i;
-                    }
-                }
+                int detection_threshold = DETECTION_THRESHOLD;
 
-                // Detect blue cones
-                int max_blue_contour_area = 0;
-                int index_blue = -1;
-                for (size_t i = 0; i < blueContours.size(); i++)
-                {
-                    cv::Rect bounding_rect_blue = cv::boundingRect(blueContours[i]);
-                    int area = bounding_rect_blue.width * bounding_rect_blue.height;
-                    // Find maximum area contour
-                    if (area > max_blue_contour_area)
-                    {
-                        max_blue_contour_area = area;
-                        index_blue = i;
-                    }
-                }
+                // Detect yellow and blue cones (largest bounding rect per colour), one colour per thread
+                detectionPool.run(coneSearches.size(), searchConeJob);
+                pipelineTimer.mark(Stage::CONTOURS);
 
                 // Assign midpoint to contour rect
-                if (index_yellow != -1)
+                ConeObservation cones{false, false, cv::Point(0, 0), cv::Point(0, 0)};
+                if (coneSearches[YELLOW].cones > 0)
                 {
-                    // Set yellowCone detection flag to 1
-                    yellowCone = 1;
+                    // Set yellow cone detection flag
+                    cones.yellow = true;
                     // Save midpoint of yellow cone contour
-                    midYellow = processContour(yellowContours[index_yellow], blurredCroppedImg, cv::Scalar(0, 255, 255), detection_threshold);
+                    cones.midYellow = processCone(coneSearches[YELLOW].largest().rect, blurredCroppedImg, cv::Scalar(0, 255, 255), detection_threshold);
                 }
 
                 // Assign midpoint to contour rect
-                if (index_blue != -1)
+                if (coneSearches[BLUE].cones > 0)
                 {
-                    // Set blueCone detection flag to 1
-                    blueCone = 1;
+                    // Set blue cone detection flag
+                    cones.blue = true;
                     // Save midpoint of blue cone contour
-                    midBlue = processContour(blueContours[index_blue], blurredCroppedImg, cv::Scalar(255, 0, 0), detection_threshold);
+                    cones.midBlue = processCone(coneSearches[BLUE].largest().rect, blurredCroppedImg, cv::Scalar(255, 0, 0), detection_threshold);
                 }
 
-                /****************** STEERING CALCULATION **********************************************/
-                // Calculate steering angle (not optimized)
-                if (blueCone && yellowCone)
-                {
-                    // check CW or CCW
-                    if (midBlue.x / midBlue.y < midYellow.x / midYellow.y)
-                    {
-                        CW++;
-                    }
-                }
-
-                // Appling steering function to angular velocity Z sensor reading
-                steeringWheelAngle = steering_function(angularVelocityZ);
-
-                // Apply offsets - based on trends observed from image analysis
-                if (CW < 0)
-                {
-                    // Case: CCW
-                    if (midBlue.x < 500)
-                    {
-                        steeringWheelAngle = steeringWheelAngle + 0.05;
-                    }
-                    if (midYellow.x > 125)
-                    {
-                        steeringWheelAngle = steeringWheelAngle - 0.05;
-                    }
-                    else
-                    {
-                        steeringWheelAngle = steeringWheelAngle + 0.05;
-                    }
-                }
-                else
+                // Outline the further tracked cones (only the largest ones are used for steering)
+                if (VERBOSE)
                 {
-                    // Case: CW
-                    if (midBlue.x > 200)
+                    for (std::size_t i = 1; i < coneSearches[YELLOW].cones; i++)
                     {
-                        steeringWheelAngle = steeringWheelAngle - 0.05;
+                        cv::rectangle(blurredCroppedImg, coneSearches[YELLOW].detector.blobs()[i].rect, cv::Scalar(0, 128, 128), 1);
                     }
-                    if (midYellow.x < 500)
+                    for (std::size_t i = 1; i < coneSearches[BLUE].cones; i++)
                     {
-                        steeringWheelAngle = steeringWheelAngle + 0.05;
+                        cv::rectangle(blurredCroppedImg, coneSearches[BLUE].detector.blobs()[i].rect, cv::Scalar(128, 0, 0), 1);
                     }
                 }
 
-                // Use multiplier at close distances
-                if (distanceUS < 0.2)
+                /****************** STEERING CALCULATION **********************************************/
+                // Sensor readings at the time the frame was captured (lock-free)
+                const int64_t frameTime = cluon::time::toMicroseconds(tStamp.second);
+                const AlignedValue alignedDistance = distance.at(frameTime, alignment);
+                const AlignedValue alignedAngularVelocity = angularVelocity.at(frameTime, alignment);
+                distanceUS = alignedDistance.valid ? alignedDistance.value : 0.0;
+                angularVelocityZ = alignedAngularVelocity.valid ? alignedAngularVelocity.value : 0.0;
+                if (VERBOSE)
                 {
-                    steeringWheelAngle = 1.2 * steeringWheelAngle;
+                    std::clog << "sensor offsets to frame: angular velocity " << alignedAngularVelocity.offset << " us, ultrasound " << alignedDistance.offset << " us" << std::endl;
                 }
 
-                // Apply thresholds to steer hard left and hard right
-                if (steeringWheelAngle > 0.155)
-                {
-                    steeringWheelAngle = 0.22;
-                }
-                else if (steeringWheelAngle < -0.15)
+                // Calculate steering angle from the cone positions and the sensor readings
+                steeringWheelAngle = steeringCore.update(cones, angularVelocityZ, distanceUS);
+                pipelineTimer.mark(Stage::STEERING);
+
+                /************** PUBLISH STEERING REQUEST ***********************************************/
+                // Send the steering angle to the actuator, stamped with the capture time of the frame it was computed from
                 {
-                    steeringWheelAngle = -0.22;
+                    opendlv::proxy::GroundSteeringRequest steeringRequest;
+                    steeringRequest.groundSteering(static_cast<float>(steeringWheelAngle));
+                    od4.send(steeringRequest, tStamp.second, SENDER_STAMP);
+                    const int64_t captureToPublish{cluon::time::toMicroseconds(cluon::time::now()) - cluon::time::toMicroseconds(tStamp.second)};
+                    if (!deadlineMonitor.record(captureToPublish) && VERBOSE)
+                    {
+                        std::clog << "deadline missed: " << captureToPublish << " us from capture to publish" << std::endl;
+                    }
                 }
 
                 /************** COMPARE TO ACTUAL VALUE OF STEERING ANGLE *******************************/
                 // Check the value of steering angle
-                // If you want to access the latest received ground steering, don't forget to lock the mutex:
-                {
-                    std::lock_guard<std::mutex> lck(gsrMutex);
-                    actual_steering = gsr.groundSteering();
-                    std::cout << "group_21;" << timeStamp << ";" << steeringWheelAngle << std::endl;
-                }
+                // The latest received ground steering is read from its mailbox without locking
+                actual_steering = groundSteering.value();
+                std::cout << "group_21;" << timeStamp << ";" << steeringWheelAngle << std::endl;
 
-                // Check if there was 0 steering
-                if (abs(actual_steering) < 0.0001)
-                {
-                    // There is 0 steering, so we do not count these frames!!
-                }
-                else
+                // Frames with 0 steering are not counted
+                if (steeringScore.add(steeringWheelAngle, actual_steering))
                 {
-                    // Increment counter for steering frames (denominator of percentage calculation)
-                    totalFrames++;
-
-                    // Calculate error
-                    error = abs(steeringWheelAngle - actual_steering);
-
-                    // We wish to be within 25 percent of the actual steering angle (ground truth)
-                    if (abs(error) <= abs(0.25 * actual_steering))
-                    {
-                        // Error is within 25 percent -- great!!
-                        totalCorrect++; // increment total correct
-                    }
-
                     // Display on image which direction algorithm steers
                     if (steeringWheelAngle > 0)
                     {
@@ -385,11 +432,7 @@ int32_t main(int32_t argc, char **argv)
                     {
                         cv::putText(blurredCroppedImg, "RIGHT", cv::Point(5, 40), cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(255, 255, 255), 1);
                     }
-
-                    // Print percent correct
-                    percentCorrect = (static_cast<double>(totalCorrect) / totalFrames * 100.0);
-                    // std::cout << "Steering Frames: " << totalFrames << " Correct: "<< percentCorrect << "%" << std::endl;
-                    // std::cout << steeringWheelAngle << "," << actual_steering << std::endl;
+                    // std::cout << "Steering Frames: " << steeringScore.frames() << " Correct: "<< steeringScore.percentCorrect() << "%" << std::endl;
                 }
 
 #ifdef TEST
@@ -397,18 +440,72 @@ int32_t main(int32_t argc, char **argv)
                 writeDataEntry(file, timeStamp, std::to_string(steeringWheelAngle), std::to_string(actual_steering));
 #endif
 
-                // Reset global variables before next frame
-                blueCone = 0;   // reset flag for blueCone found
-                yellowCone = 0; // reset flag for yellowCone found
-                error = 0.0;    // reset error
-
                 // Display image on your screen.
                 if (VERBOSE)
                 {
-                    // cv::imshow(sharedMemory->name().c_str(), img);
+                    // cv::imshow(frameSource.name().c_str(), img);
                     cv::imshow("SteeringView - Group_21 Microservice", blurredCroppedImg);
                     cv::waitKey(1);
                 }
+                pipelineTimer.mark(Stage::OUTPUT);
+                pipelineTimer.end();
+
+                // Count the frames that were overwritten or arrived during this one, then let the producer continue (handshake)
+                frameCounter.record(frameSource.skippedFrames(), frameSource.newerFrameAvailable());
+                frameSource.frameDone();
+                if (HANDSHAKE && (frameSource.handshakeSuspended() != handshakeSuspended))
+                {
+                    handshakeSuspended = !handshakeSuspended;
+                    std::cerr << argv[0] << ": Handshake with the producer of '" << frameSource.name() << "' "
+                              << (handshakeSuspended ? "suspended (a frame was not done within 1 s); frames may be dropped until it resumes." : "resumed.") << std::endl;
+                }
+
+                // Report where the time went in the last interval: table on stderr, one message per stage on the OD4 bus
+                if ((STATS_INTERVAL.count() > 0) && pipelineTimer.reportDue(STATS_INTERVAL))
+                {
+                    pipelineTimer.print(std::cerr);
+                    const cluon::data::TimeStamp now{cluon::time::now()};
+                    for (std::size_t i = 0; i < STAGES; i++)
+                    {
+                        const Stage stage{static_cast<Stage>(i)};
+                        const LatencyHistogram &histogram = pipelineTimer.histogram(stage);
+                        steering::PipelineLatency latency;
+                        latency.stage(static_cast<uint8_t>(i))
+                            .name(stageName(stage))
+                            .samples(static_cast<uint32_t>(histogram.count()))
+                            .p50(histogram.percentile(0.5))
+                            .p99(histogram.percentile(0.99))
+                            .p999(histogram.percentile(0.999))
+                            .maximum(histogram.max());
+                        od4.send(latency, now, static_cast<uint32_t>(i));
+                    }
+                    pipelineTimer.reset();
+
+                    deadlineMonitor.print(std::cerr);
+                    const LatencyHistogram &publishLatency = deadlineMonitor.histogram();
+                    steering::PublishLatency publish;
+                    publish.samples(static_cast<uint32_t>(publishLatency.count()))
+                        .p50(publishLatency.percentile(0.5))
+                        .p99(publishLatency.percentile(0.99))
+                        .p999(publishLatency.percentile(0.999))
+                        .maximum(publishLatency.max())
+                        .deadline(static_cast<uint32_t>(deadlineMonitor.budget().count()))
+                        .misses(static_cast<uint32_t>(deadlineMonitor.misses()));
+                    od4.send(publish, now);
+                    deadlineMonitor.reset();
+
+                    if (frameSource.hasFrameSequenceNumbers())
+                    {
+                        frameCounter.print(std::cerr);
+                        steering::FrameDrops drops;
+                        drops.frames(static_cast<uint32_t>(frameCounter.frames()))
+                            .dropped(static_cast<uint32_t>(frameCounter.dropped()))
+                            .late(static_cast<uint32_t>(frameCounter.late()))
+                            .dropRate(static_cast<float>(frameCounter.dropRate()));
+                        od4.send(drops, now);
+                    }
+                    frameCounter.reset();
+                }
             }
         }
         retCode = 0;
@@ -421,29 +518,16 @@ int32_t main(int32_t argc, char **argv)
     return retCode;
 }
 
-// Define the steering function from curve fitting
-double steering_function(double X)
-{
-    // Coefficients
-    double a = 0.14973124;  // approximately half of steering range
-    double b = 0.02949003;  // scaling factor for angular velocity Z
-    double c = -0.00177955; // this can even be zero!
-
-    // Calculate and return the result
-    return a * std::atan(b * X) + c;
-}
-
-// Function to process contours -- finds midpoint and draws box around cone
-cv::Point processContour(const std::vector<cv::Point> &contour, cv::Mat &image, const cv::Scalar &color, int detection_threshold)
+// Function to process a detected cone -- finds midpoint and draws box around cone
+cv::Point processCone(const cv::Rect &bounding_rect, cv::Mat &image, const cv::Scalar &color, int detection_threshold)
 {
-    cv::Rect bounding_rect = cv::boundingRect(contour);
     int area = bounding_rect.width * bounding_rect.height;
     if (area > detection_threshold)
     {
         // Create bounding rectangle
         cv::rectangle(image, bounding_rect, color, 1);
         // Find midpoint of rectangle
-        cv::Point midpoint(bounding_rect.x + bounding_rect.width / 2, bounding_rect.y + bounding_rect.height / 2);
+        cv::Point midpoint = coneMidpoint(bounding_rect, detection_threshold);
         // Draw midpoint
         cv::circle(image, midpoint, 2, color, -1);
         // Put coordinates as text on display image
@@ -457,6 +541,33 @@ cv::Point processContour(const std::vector<cv::Point> &contour, cv::Mat &image,
     return cv::Point(-1, -1);
 }
 
+// Parses the optional command line value key as a count in [min, max] into value (unchanged if the
+// key is absent); returns false if the value is not a number or out of range.
+bool parseCount(std::map<std::string, std::string> &commandlineArguments, const std::string &key, uint32_t min, uint32_t max, uint32_t &value)
+{
+    if (commandlineArguments.count(key) == 0)
+    {
+        return true;
+    }
+    const std::string VALUE{commandlineArguments[key]};
+    long long parsed{-1};
+    std::size_t length{0};
+    try
+    {
+        parsed = std::stoll(VALUE, &length);
+    }
+    catch (const std::exception &)
+    {
+        return false;
+    }
+    if ((length != VALUE.size()) || (parsed < static_cast<long long>(min)) || (parsed > static_cast<long long>(max)))
+    {
+        return false;
+    }
+    value = static_cast<uint32_t>(parsed);
+    return true;
+}
+
 #ifdef TEST
 // Function that is called every frame to write the plotting data
 void writeDataEntry(std::ofstream &file, const std::string &ts, const std::string &calculatedValue, const std::string &actualValue)
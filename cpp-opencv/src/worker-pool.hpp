@@ -0,0 +1,272 @@
+/* Title: Worker Pool - threads for running the per-colour detection and batches of long jobs in parallel
+ * Authors: Nasit Vurgun, Sam Hardingham, Kai Rowley, Daniel van den Heuvel
+ * Institution: University of Gothenburg, Sweden
+ * Course: DIT638/DIT639 (2024), taught by Prof. Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef WORKER_POOL_HPP
+#define WORKER_POOL_HPP
+
+#include <algorithm>          // For std::min, std::max
+#include <atomic>             // For handing out job indices
+#include <condition_variable> // For waking up the workers
+#include <cstddef>            // For std::size_t
+#include <cstdint>            // For fixed width integers
+#include <deque>              // For the per-thread job queues
+#include <functional>         // For the job type
+#include <iostream>           // For reporting pinning failures
+#include <mutex>              // For the start/done handshake
+#include <sstream>            // For parsing CPU lists
+#include <string>             // For CPU lists
+#include <thread>             // For the workers
+#include <vector>             // For the threads
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// Pins a thread to a single CPU; returns false if that is not possible on this platform.
+inline bool pinThread(std::thread::native_handle_type handle, int cpu)
+{
+#ifdef __linux__
+    if ((cpu < 0) || (cpu >= CPU_SETSIZE))
+    {
+        return false;
+    }
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu, &cpus);
+    return 0 == pthread_setaffinity_np(handle, sizeof(cpus), &cpus);
+#else
+    (void)handle;
+    (void)cpu;
+    return false;
+#endif
+}
+
+inline bool pinCurrentThread(int cpu)
+{
+#ifdef __linux__
+    return pinThread(pthread_self(), cpu);
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+// Parses a comma-separated list of CPU numbers such as "2,3".
+inline std::vector<int> parseCpuList(const std::string &list)
+{
+    std::vector<int> cpus;
+    std::istringstream stream(list);
+    std::string cpu;
+    while (std::getline(stream, cpu, ','))
+    {
+        if (!cpu.empty())
+        {
+            cpus.push_back(std::stoi(cpu));
+        }
+    }
+    return cpus;
+}
+
+// Fixed set of threads that execute a batch of indexed jobs together with the calling thread
+// (fork/join). The threads are created once and sleep between batches, so a batch costs one
+// wake-up instead of a thread creation; the frame latency is bounded by the slowest job.
+class WorkerPool
+{
+private:
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool(WorkerPool &&) = delete;
+    WorkerPool &operator=(const WorkerPool &) = delete;
+    WorkerPool &operator=(WorkerPool &&) = delete;
+
+public:
+    // cpus[i] (if given) is the CPU worker i is pinned to.
+    explicit WorkerPool(std::size_t workers, const std::vector<int> &cpus = std::vector<int>())
+        : m_threads(), m_mutex(), m_start(), m_done()
+    {
+        for (std::size_t i = 0; i < workers; i++)
+        {
+            m_threads.emplace_back(&WorkerPool::loop, this);
+            if ((i < cpus.size()) && !pinThread(m_threads.back().native_handle(), cpus[i]))
+            {
+                // The worker still runs, only unpinned (e.g. the CPU is not in this process' cpuset).
+                std::cerr << "WorkerPool: Could not pin worker " << i << " to CPU " << cpus[i] << "." << std::endl;
+            }
+        }
+    }
+
+    ~WorkerPool()
+    {
+        {
+            std::lock_guard<std::mutex> lck(m_mutex);
+            m_stop = true;
+        }
+        m_start.notify_all();
+        for (auto &thread : m_threads)
+        {
+            thread.join();
+        }
+    }
+
+    std::size_t workers() const
+    {
+        return m_threads.size();
+    }
+
+    // Runs job(0) ... job(count - 1) on the workers and the calling thread; returns when all jobs are done.
+    void run(std::size_t count, const std::function<void(std::size_t)> &job)
+    {
+        if (m_threads.empty())
+        {
+            for (std::size_t i = 0; i < count; i++)
+            {
+                job(i);
+            }
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lck(m_mutex);
+            m_job = &job;
+            m_count = count;
+            m_next.store(0);
+            m_busy = m_threads.size();
+            m_generation++;
+        }
+        m_start.notify_all();
+
+        work();
+
+        std::unique_lock<std::mutex> lck(m_mutex);
+        m_done.wait(lck, [this]() { return 0 == m_busy; });
+        m_job = nullptr;
+    }
+
+private:
+    // Takes jobs until the batch is exhausted.
+    void work()
+    {
+        for (std::size_t i = m_next.fetch_add(1); i < m_count; i = m_next.fetch_add(1))
+        {
+            (*m_job)(i);
+        }
+    }
+
+    void loop()
+    {
+        uint64_t seen{0};
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lck(m_mutex);
+                m_start.wait(lck, [this, &seen]() { return m_stop || (m_generation != seen); });
+                if (m_stop)
+                {
+                    return;
+                }
+                seen = m_generation;
+            }
+
+            work();
+
+            {
+                std::lock_guard<std::mutex> lck(m_mutex);
+                m_busy--;
+            }
+            m_done.notify_one();
+        }
+    }
+
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_start;
+    std::condition_variable m_done;
+    const std::function<void(std::size_t)> *m_job{nullptr};
+    std::size_t m_count{0};
+    std::atomic<std::size_t> m_next{0};
+    std::size_t m_busy{0};
+    uint64_t m_generation{0};
+    bool m_stop{false};
+};
+
+// Runs job(0) ... job(count - 1) on up to threads threads that exist for this batch only; for
+// long, uneven jobs such as replaying one recording each. The jobs are dealt round-robin in index
+// order into one queue per thread (so callers put the expensive ones first). Each thread takes
+// from the front of its own queue and, once that is empty, steals from the back of the others.
+inline void runWorkStealing(std::size_t count, std::size_t threads, const std::function<void(std::size_t)> &job)
+{
+    struct Queue
+    {
+        std::mutex mutex{};
+        std::deque<std::size_t> jobs{};
+    };
+
+    threads = std::max<std::size_t>(1, std::min(threads, count));
+    std::vector<Queue> queues(threads);
+    for (std::size_t i = 0; i < count; i++)
+    {
+        queues[i % threads].jobs.push_back(i);
+    }
+
+    auto take = [&queues, threads](std::size_t self, std::size_t &next)
+    {
+        for (std::size_t k = 0; k < threads; k++)
+        {
+            const std::size_t victim = (self + k) % threads;
+            std::lock_guard<std::mutex> lck(queues[victim].mutex);
+            std::deque<std::size_t> &jobs = queues[victim].jobs;
+            if (!jobs.empty())
+            {
+                if (victim == self)
+                {
+                    next = jobs.front();
+                    jobs.pop_front();
+                }
+                else
+                {
+                    next = jobs.back();
+                    jobs.pop_back();
+                }
+                return true;
+            }
+        }
+        return false;
+    };
+    auto work = [&take, &job](std::size_t self)
+    {
+        std::size_t next{0};
+        while (take(self, next))
+        {
+            job(next);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (std::size_t t = 1; t < threads; t++)
+    {
+        workers.emplace_back(work, t);
+    }
+    work(0);
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+#endif
@@ -0,0 +1,125 @@
+/* Title: Tests for the BlobDetector against cv::findContours
+ * Authors: Nasit Vurgun, Sam Hardingham, Kai Rowley, Daniel van den Heuvel
+ * Institution: University of Gothenburg, Sweden
+ * Course: DIT638/DIT639 (2024), taught by Prof. Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "catch.hpp"
+#include "blob-detector.hpp"
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace
+{
+    // Random noise or random (outlined and filled) rectangles, which produce holes, nested regions, and ties.
+    cv::Mat randomMask(std::mt19937 &rng, bool rectangles)
+    {
+        const int ROWS = std::uniform_int_distribution<int>(1, 120)(rng);
+        const int COLS = std::uniform_int_distribution<int>(1, 160)(rng);
+        cv::Mat mask = cv::Mat::zeros(ROWS, COLS, CV_8UC1);
+        if (rectangles)
+        {
+            const int RECTANGLES = std::uniform_int_distribution<int>(1, 12)(rng);
+            for (int i = 0; i < RECTANGLES; i++)
+            {
+                const cv::Point tl(std::uniform_int_distribution<int>(0, COLS - 1)(rng), std::uniform_int_distribution<int>(0, ROWS - 1)(rng));
+                const cv::Point br(tl.x + std::uniform_int_distribution<int>(1, 14)(rng), tl.y + std::uniform_int_distribution<int>(1, 14)(rng));
+                const int THICKNESS[] = {1, 2, -1};
+                cv::rectangle(mask, tl, br, cv::Scalar(255), THICKNESS[std::uniform_int_distribution<int>(0, 2)(rng)]);
+            }
+        }
+        else
+        {
+            std::bernoulli_distribution pixel(std::uniform_real_distribution<double>(0.02, 0.7)(rng));
+            for (int y = 0; y < ROWS; y++)
+            {
+                uint8_t *row = mask.ptr<uint8_t>(y);
+                for (int x = 0; x < COLS; x++)
+                {
+                    row[x] = pixel(rng) ? 255 : 0;
+                }
+            }
+        }
+        return mask;
+    }
+
+    bool rectLess(const cv::Rect &a, const cv::Rect &b)
+    {
+        return (a.x != b.x) ? (a.x < b.x) : ((a.y != b.y) ? (a.y < b.y) : ((a.width != b.width) ? (a.width < b.width) : (a.height < b.height)));
+    }
+}
+
+TEST_CASE("BlobDetector finds the regions and the largest bounding rect of cv::findContours on random masks.")
+{
+    std::mt19937 rng(638);
+    BlobDetector detector;
+    for (int i = 0; i < 2000; i++)
+    {
+        const cv::Mat MASK = randomMask(rng, 0 == i % 2);
+
+        cv::Mat image = MASK.clone();
+        std::vector<std::vector<cv::Point>> contours;
+        std::vector<cv::Vec4i> hierarchy;
+        cv::findContours(image, contours, hierarchy, cv::RETR_TREE, cv::CHAIN_APPROX_SIMPLE);
+
+        // The former selection in the frame loop: first contour with the largest bounding rect.
+        // Outer contours are those at an even depth of the hierarchy (the others are holes).
+        bool found = false;
+        int maxArea = 0;
+        cv::Rect largest;
+        std::vector<cv::Rect> outer;
+        for (std::size_t c = 0; c < contours.size(); c++)
+        {
+            const cv::Rect RECT = cv::boundingRect(contours[c]);
+            if (RECT.width * RECT.height > maxArea)
+            {
+                maxArea = RECT.width * RECT.height;
+                largest = RECT;
+                found = true;
+            }
+            int depth = 0;
+            for (int parent = hierarchy[c][3]; parent >= 0; parent = hierarchy[static_cast<std::size_t>(parent)][3])
+            {
+                depth++;
+            }
+            if (0 == depth % 2)
+            {
+                outer.push_back(RECT);
+            }
+        }
+
+        std::vector<cv::Rect> blobs;
+        for (const Blob &blob : detector.detect(MASK))
+        {
+            blobs.push_back(blob.rect);
+        }
+        std::sort(outer.begin(), outer.end(), rectLess);
+        std::sort(blobs.begin(), blobs.end(), rectLess);
+
+        INFO("mask " << i << " (" << MASK.rows << "x" << MASK.cols << ")");
+        REQUIRE(outer == blobs);
+        REQUIRE(found == (detector.topK(1) > 0));
+        if (found)
+        {
+            REQUIRE(largest == detector.blobs().front().rect);
+        }
+    }
+}
@@ -0,0 +1,190 @@
+/* Title: Tests for the fused cone mask kernels against cv::cvtColor and cv::inRange
+ * Authors: Nasit Vurgun, Sam Hardingham, Kai Rowley, Daniel van den Heuvel
+ * Institution: University of Gothenburg, Sweden
+ * Course: DIT638/DIT639 (2024), taught by Prof. Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "catch.hpp"
+#include "cone-mask.hpp"
+#include "steering-core.hpp"
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include <random>
+#include <vector>
+
+namespace
+{
+    // Every instruction set that masksRow() can use on this machine.
+    std::vector<conemask::Isa> availableIsas()
+    {
+        std::vector<conemask::Isa> isas{conemask::Isa::SCALAR};
+        switch (conemask::detectIsa())
+        {
+        case conemask::Isa::AVX2:
+            isas.push_back(conemask::Isa::SSE41);
+            isas.push_back(conemask::Isa::AVX2);
+            break;
+        case conemask::Isa::SSE41:
+            isas.push_back(conemask::Isa::SSE41);
+            break;
+        case conemask::Isa::NEON:
+            isas.push_back(conemask::Isa::NEON);
+            break;
+        case conemask::Isa::SCALAR:
+            break;
+        }
+        return isas;
+    }
+
+    struct Range
+    {
+        cv::Scalar min;
+        cv::Scalar max;
+    };
+
+    // The cone colours, the full range, single hue/saturation/value levels at the ends of their
+    // ranges, and random ranges (narrow ones catch HSV values that are off by one).
+    std::vector<Range> ranges(std::mt19937 &rng)
+    {
+        std::vector<Range> result{{YELLOW_MIN, YELLOW_MAX}, {BLUE_MIN, BLUE_MAX},
+                                  {cv::Scalar(0, 0, 0), cv::Scalar(255, 255, 255)},
+                                  {cv::Scalar(0, 0, 0), cv::Scalar(0, 255, 255)},
+                                  {cv::Scalar(179, 0, 0), cv::Scalar(180, 255, 255)},
+                                  {cv::Scalar(0, 0, 0), cv::Scalar(179, 0, 255)},
+                                  {cv::Scalar(0, 255, 0), cv::Scalar(179, 255, 255)},
+                                  {cv::Scalar(0, 0, 0), cv::Scalar(179, 255, 0)},
+                                  {cv::Scalar(0, 0, 255), cv::Scalar(179, 255, 255)}};
+        std::uniform_int_distribution<int> hue(0, 179);
+        std::uniform_int_distribution<int> byte(0, 255);
+        std::uniform_int_distribution<int> width(0, 3);
+        for (int i = 0; i < 15; i++)
+        {
+            const int H = hue(rng), S = byte(rng), V = byte(rng);
+            result.push_back({cv::Scalar(H, S, V), cv::Scalar(H + width(rng), S + width(rng), V + width(rng))});
+        }
+        return result;
+    }
+
+    void referenceMasks(const cv::Mat &bgra, const Range &a, const Range &b, cv::Mat &maskA, cv::Mat &maskB)
+    {
+        cv::Mat hsv;
+        cv::cvtColor(bgra, hsv, cv::COLOR_BGR2HSV);
+        cv::inRange(hsv, a.min, a.max, maskA);
+        cv::inRange(hsv, b.min, b.max, maskB);
+    }
+
+    void kernelMasks(conemask::Isa isa, const cv::Mat &bgra, const Range &a, const Range &b, cv::Mat &maskA, cv::Mat &maskB)
+    {
+        maskA.create(bgra.rows, bgra.cols, CV_8UC1);
+        maskB.create(bgra.rows, bgra.cols, CV_8UC1);
+        const conemask::HsvBounds A = conemask::toBounds(a.min, a.max);
+        const conemask::HsvBounds B = conemask::toBounds(b.min, b.max);
+        for (int row = 0; row < bgra.rows; row++)
+        {
+            conemask::masksRow(isa, bgra.ptr<uint8_t>(row), bgra.cols, A, B, maskA.ptr<uint8_t>(row), maskB.ptr<uint8_t>(row));
+        }
+    }
+
+    bool equal(const cv::Mat &a, const cv::Mat &b)
+    {
+        return (a.size() == b.size()) && (0 == cv::countNonZero(a != b));
+    }
+}
+
+TEST_CASE("Every cone mask kernel matches cvtColor and inRange for all BGR colours.")
+{
+    // 4096 x 4096 BGRA pixels hold each of the 2^24 BGR colours once; the alpha channel is random.
+    std::mt19937 rng(639);
+    cv::Mat bgra(4096, 4096, CV_8UC4);
+    std::uniform_int_distribution<int> byte(0, 255);
+    for (int y = 0; y < bgra.rows; y++)
+    {
+        uint8_t *row = bgra.ptr<uint8_t>(y);
+        for (int x = 0; x < bgra.cols; x++)
+        {
+            const uint32_t COLOUR = static_cast<uint32_t>(y) * 4096 + static_cast<uint32_t>(x);
+            row[4 * x + 0] = static_cast<uint8_t>(COLOUR & 0xFF);
+            row[4 * x + 1] = static_cast<uint8_t>((COLOUR >> 8) & 0xFF);
+            row[4 * x + 2] = static_cast<uint8_t>((COLOUR >> 16) & 0xFF);
+            row[4 * x + 3] = static_cast<uint8_t>(byte(rng));
+        }
+    }
+
+    const std::vector<Range> RANGES = ranges(rng);
+    cv::Mat expectedA, expectedB, maskA, maskB;
+    for (std::size_t r = 0; r + 1 < RANGES.size(); r += 2)
+    {
+        referenceMasks(bgra, RANGES[r], RANGES[r + 1], expectedA, expectedB);
+        for (conemask::Isa isa : availableIsas())
+        {
+            kernelMasks(isa, bgra, RANGES[r], RANGES[r + 1], maskA, maskB);
+            INFO(conemask::isaName(isa) << ", ranges " << r << " and " << r + 1);
+            REQUIRE(equal(expectedA, maskA));
+            REQUIRE(equal(expectedB, maskB));
+        }
+    }
+}
+
+TEST_CASE("Every cone mask kernel matches cvtColor and inRange for rows of any length.")
+{
+    // Widths of 1 to 67 pixels leave every possible remainder after the 4, 8, and 16 pixel vector loops.
+    std::mt19937 rng(638);
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::uniform_int_distribution<int> edge(0, 5);
+    const uint8_t EDGE_VALUES[] = {0, 1, 127, 128, 254, 255};
+    const std::vector<Range> RANGES = ranges(rng);
+    cv::Mat expectedA, expectedB, maskA, maskB;
+    for (int cols = 1; cols <= 67; cols++)
+    {
+        cv::Mat bgra(7, cols, CV_8UC4);
+        for (int y = 0; y < bgra.rows; y++)
+        {
+            uint8_t *row = bgra.ptr<uint8_t>(y);
+            for (int i = 0; i < 4 * cols; i++)
+            {
+                // Odd rows mix in saturated, grey, and tied channels.
+                row[i] = (0 == y % 2) ? static_cast<uint8_t>(byte(rng)) : EDGE_VALUES[edge(rng)];
+            }
+        }
+        for (std::size_t r = 0; r + 1 < RANGES.size(); r += 2)
+        {
+            referenceMasks(bgra, RANGES[r], RANGES[r + 1], expectedA, expectedB);
+            for (conemask::Isa isa : availableIsas())
+            {
+                kernelMasks(isa, bgra, RANGES[r], RANGES[r + 1], maskA, maskB);
+                INFO(conemask::isaName(isa) << ", " << cols << " columns, ranges " << r << " and " << r + 1);
+                REQUIRE(equal(expectedA, maskA));
+                REQUIRE(equal(expectedB, maskB));
+            }
+        }
+    }
+}
+
+TEST_CASE("fusedConeMasks matches cvtColor and inRange on a region of interest.")
+{
+    cv::Mat frame(480, 640, CV_8UC4);
+    cv::randu(frame, cv::Scalar::all(0), cv::Scalar::all(256));
+    // Not continuous, and the rows start at an odd pixel.
+    const cv::Mat ROI = frame(cv::Rect(3, 255, 601, 144));
+
+    cv::Mat expectedYellow, expectedBlue, yellow, blue;
+    referenceMasks(ROI, {YELLOW_MIN, YELLOW_MAX}, {BLUE_MIN, BLUE_MAX}, expectedYellow, expectedBlue);
+    fusedConeMasks(ROI, YELLOW_MIN, YELLOW_MAX, BLUE_MIN, BLUE_MAX, yellow, blue);
+    REQUIRE(equal(expectedYellow, yellow));
+    REQUIRE(equal(expectedBlue, blue));
+}
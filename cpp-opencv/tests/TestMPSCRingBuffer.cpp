@@ -0,0 +1,153 @@
+/* Title: Tests for cluon::MPSCRingBuffer with several producer threads
+ * Authors: Nasit Vurgun, Sam Hardingham, Kai Rowley, Daniel van den Heuvel
+ * Institution: University of Gothenburg, Sweden
+ * Course: DIT638/DIT639 (2024), taught by Prof. Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "catch.hpp"
+#include "cluon-complete.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    // Entries carry their producer in the upper and a per-producer counter in the lower 32 bits.
+    uint64_t entryOf(uint32_t producer, uint32_t i)
+    {
+        return (static_cast<uint64_t>(producer) << 32) | i;
+    }
+}
+
+TEST_CASE("MPSCRingBuffer delivers every entry of several producers exactly once and in order per producer.")
+{
+    const uint32_t PRODUCERS{4};
+    const uint32_t ENTRIES_PER_PRODUCER{200000};
+    cluon::MPSCRingBuffer<uint64_t> ring{64};
+    REQUIRE(64 == ring.capacity());
+    REQUIRE(ring.empty());
+
+    std::atomic<bool> start{false};
+    std::vector<std::thread> producers;
+    for (uint32_t p{0}; p < PRODUCERS; p++)
+    {
+        producers.emplace_back([&ring, &start, p, ENTRIES_PER_PRODUCER]() {
+            while (!start.load())
+            {
+                std::this_thread::yield();
+            }
+            for (uint32_t i{0}; i < ENTRIES_PER_PRODUCER; i++)
+            {
+                uint64_t entry{entryOf(p, i)};
+                while (!ring.push(entry))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    std::vector<uint32_t> next(PRODUCERS, 0);
+    uint64_t received{0};
+    bool ordered{true};
+    start.store(true);
+    while (received < static_cast<uint64_t>(PRODUCERS) * ENTRIES_PER_PRODUCER)
+    {
+        uint64_t entry{0};
+        if (!ring.pop(entry))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        const uint32_t PRODUCER{static_cast<uint32_t>(entry >> 32)};
+        const uint32_t I{static_cast<uint32_t>(entry & 0xFFFFFFFFu)};
+        ordered &= (PRODUCER < PRODUCERS) && (next[PRODUCER] == I);
+        if (PRODUCER < PRODUCERS)
+        {
+            next[PRODUCER] = I + 1;
+        }
+        received++;
+    }
+    for (auto &producer : producers)
+    {
+        producer.join();
+    }
+
+    REQUIRE(ordered);
+    REQUIRE(ring.empty());
+    for (uint32_t p{0}; p < PRODUCERS; p++)
+    {
+        REQUIRE(ENTRIES_PER_PRODUCER == next[p]);
+    }
+}
+
+TEST_CASE("MPSCRingBuffer stays consistent when producers discard the oldest entry while the consumer pops.")
+{
+    // As with OverflowPolicy::DROP_OLDEST: a producer that finds the ring buffer full pops one entry itself.
+    const uint32_t PRODUCERS{4};
+    const uint32_t ENTRIES_PER_PRODUCER{100000};
+    cluon::MPSCRingBuffer<uint64_t> ring{8};
+
+    std::atomic<uint64_t> discarded{0};
+    std::atomic<uint32_t> running{PRODUCERS};
+    std::vector<std::thread> producers;
+    for (uint32_t p{0}; p < PRODUCERS; p++)
+    {
+        producers.emplace_back([&ring, &discarded, &running, p, ENTRIES_PER_PRODUCER]() {
+            for (uint32_t i{0}; i < ENTRIES_PER_PRODUCER; i++)
+            {
+                uint64_t entry{entryOf(p, i)};
+                while (!ring.push(entry))
+                {
+                    uint64_t oldest{0};
+                    if (ring.pop(oldest))
+                    {
+                        discarded++;
+                    }
+                }
+            }
+            running--;
+        });
+    }
+
+    std::vector<int64_t> last(PRODUCERS, -1);
+    uint64_t received{0};
+    bool ordered{true};
+    while ((0 < running.load()) || !ring.empty())
+    {
+        uint64_t entry{0};
+        if (ring.pop(entry))
+        {
+            const uint32_t PRODUCER{static_cast<uint32_t>(entry >> 32)};
+            const int64_t I{static_cast<int64_t>(entry & 0xFFFFFFFFu)};
+            ordered &= (PRODUCER < PRODUCERS) && (last[PRODUCER] < I);
+            if (PRODUCER < PRODUCERS)
+            {
+                last[PRODUCER] = I;
+            }
+            received++;
+        }
+    }
+    for (auto &producer : producers)
+    {
+        producer.join();
+    }
+
+    REQUIRE(ordered);
+    REQUIRE(static_cast<uint64_t>(PRODUCERS) * ENTRIES_PER_PRODUCER == received + discarded.load());
+}
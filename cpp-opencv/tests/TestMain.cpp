@@ -0,0 +1,3 @@
+#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main() - only do this once per test-runner!
+
+#include "catch.hpp"
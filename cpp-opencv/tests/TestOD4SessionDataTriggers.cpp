@@ -0,0 +1,122 @@
+/* Title: Tests for changing the data-triggered delegates of cluon::OD4Session while receiving
+ * Authors: Nasit Vurgun, Sam Hardingham, Kai Rowley, Daniel van den Heuvel
+ * Institution: University of Gothenburg, Sweden
+ * Course: DIT638/DIT639 (2024), taught by Prof. Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "catch.hpp"
+#include "cluon-complete.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <thread>
+
+namespace
+{
+    void sendTimeStamps(cluon::OD4Session &sender, uint32_t count)
+    {
+        for (uint32_t i{1}; i <= count; i++)
+        {
+            cluon::data::TimeStamp ts;
+            ts.microseconds(static_cast<int32_t>(i));
+            sender.send(ts);
+            cluon::data::PlayerStatus status;
+            sender.send(status);
+            if (0 == i % 50)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+    }
+
+    // Registers, replaces, and removes delegates for dataTypes 5000 to 5049 and for
+    // PlayerStatus from another thread and from within a running delegate while Envelopes arrive.
+    void changeDelegatesWhileReceiving(uint16_t CID, uint32_t numberOfDelegateWorkers)
+    {
+        const uint32_t ENVELOPES{2000};
+        cluon::OD4Session od4{CID, nullptr, numberOfDelegateWorkers};
+        cluon::OD4Session sender{CID};
+        REQUIRE(od4.isRunning());
+
+        std::atomic<uint32_t> timeStamps{0};
+        std::atomic<uint32_t> playerStatusFirst{0};
+        std::atomic<uint32_t> playerStatusSecond{0};
+        std::atomic<uint32_t> unused{0};
+        od4.dataTrigger(cluon::data::TimeStamp::ID(), [&](cluon::data::Envelope &&) {
+            const uint32_t N{++timeStamps};
+            // Changing the delegates from within a delegate used to deadlock on the map's mutex.
+            if (10 == N)
+            {
+                od4.dataTrigger(cluon::data::PlayerStatus::ID(), [&playerStatusFirst](cluon::data::Envelope &&) { playerStatusFirst++; });
+            }
+            else if (ENVELOPES / 2 == N)
+            {
+                od4.dataTrigger(cluon::data::PlayerStatus::ID(), [&playerStatusSecond](cluon::data::Envelope &&) { playerStatusSecond++; });
+            }
+        });
+
+        std::atomic<bool> stop{false};
+        std::thread churn([&od4, &stop, &unused]() {
+            uint32_t i{0};
+            while (!stop.load())
+            {
+                const int32_t DATA_TYPE{static_cast<int32_t>(5000 + (i % 50))};
+                if (0 == i % 2)
+                {
+                    od4.dataTrigger(DATA_TYPE, [&unused](cluon::data::Envelope &&) { unused++; });
+                }
+                else
+                {
+                    od4.dataTrigger(DATA_TYPE, nullptr);
+                }
+                i++;
+            }
+        });
+        sendTimeStamps(sender, ENVELOPES);
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        stop.store(true);
+        churn.join();
+
+        REQUIRE(timeStamps.load() >= ENVELOPES / 2);
+        REQUIRE(0 < playerStatusFirst.load());
+        REQUIRE(0 < playerStatusSecond.load());
+        REQUIRE(0 == unused.load());
+
+        // Once removed (and the Envelopes in flight are delivered), a delegate is not called anymore.
+        REQUIRE(od4.dataTrigger(cluon::data::TimeStamp::ID(), nullptr));
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        const uint32_t BEFORE{timeStamps.load()};
+        const uint32_t FIRST{playerStatusFirst.load()};
+        const uint32_t SECOND{playerStatusSecond.load()};
+        sendTimeStamps(sender, 100);
+        std::this_thread::sleep_for(std::chrono::milliseconds(300));
+        REQUIRE(BEFORE == timeStamps.load());
+        REQUIRE(FIRST == playerStatusFirst.load());
+        REQUIRE(SECOND < playerStatusSecond.load());
+    }
+}
+
+TEST_CASE("Data-triggered delegates can be changed while the receiving thread dispatches to them.")
+{
+    changeDelegatesWhileReceiving(183, 0);
+}
+
+TEST_CASE("Data-triggered delegates can be changed while the delegate workers dispatch to them.")
+{
+    changeDelegatesWhileReceiving(184, 2);
+}
@@ -0,0 +1,164 @@
+/* Title: Tests for the delegate workers of cluon::OD4Session
+ * Authors: Nasit Vurgun, Sam Hardingham, Kai Rowley, Daniel van den Heuvel
+ * Institution: University of Gothenburg, Sweden
+ * Course: DIT638/DIT639 (2024), taught by Prof. Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "catch.hpp"
+#include "cluon-complete.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    const cluon::OD4Session::DelegateQueueStatistics *statisticsFor(const std::vector<cluon::OD4Session::DelegateQueueStatistics> &statistics, int32_t dataType, uint32_t senderStamp)
+    {
+        for (const auto &s : statistics)
+        {
+            if ((s.m_dataType == dataType) && (s.m_senderStamp == senderStamp))
+            {
+                return &s;
+            }
+        }
+        return nullptr;
+    }
+
+    // Waits until nothing is queued anymore for any dataType/senderStamp.
+    void waitUntilDrained(const cluon::OD4Session &od4)
+    {
+        const auto DEADLINE = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        bool drained{false};
+        while (!drained && (std::chrono::steady_clock::now() < DEADLINE))
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            drained = true;
+            for (const auto &s : od4.delegateQueueStatistics())
+            {
+                drained &= (0 == s.m_queued);
+            }
+        }
+    }
+}
+
+TEST_CASE("A busy dataType does not evict the Envelopes of a rare one on the same delegate worker.")
+{
+    const uint32_t BUSY{600};
+    const uint32_t RARE{20};
+
+    cluon::OD4Session od4{181, nullptr, 1};
+    cluon::OD4Session sender{181};
+    REQUIRE(od4.isRunning());
+
+    std::atomic<uint32_t> busy{0};
+    std::atomic<uint32_t> rare{0};
+    std::atomic<bool> rareInOrder{true};
+    uint32_t lastRare{0};
+    od4.dataTrigger(cluon::data::PlayerStatus::ID(), [&busy](cluon::data::Envelope &&) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        busy++;
+    });
+    od4.dataTrigger(cluon::data::TimeStamp::ID(), [&](cluon::data::Envelope &&env) {
+        const uint32_t I{static_cast<uint32_t>(cluon::extractMessage<cluon::data::TimeStamp>(std::move(env)).microseconds())};
+        rareInOrder = rareInOrder && (I == lastRare + 1);
+        lastRare = I;
+        rare++;
+    });
+
+    for (uint32_t i{1}; i <= BUSY; i++)
+    {
+        cluon::data::PlayerStatus status;
+        sender.send(status);
+        if (0 == i % (BUSY / RARE))
+        {
+            cluon::data::TimeStamp ts;
+            ts.microseconds(static_cast<int32_t>(i / (BUSY / RARE)));
+            sender.send(ts);
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    waitUntilDrained(od4);
+
+    const auto STATISTICS{od4.delegateQueueStatistics()};
+    const auto *busyStatistics = statisticsFor(STATISTICS, cluon::data::PlayerStatus::ID(), 0);
+    const auto *rareStatistics = statisticsFor(STATISTICS, cluon::data::TimeStamp::ID(), 0);
+    REQUIRE(nullptr != busyStatistics);
+    REQUIRE(nullptr != rareStatistics);
+    REQUIRE(busyStatistics->m_worker == rareStatistics->m_worker);
+
+    // The busy dataType overflows its own queue only.
+    REQUIRE(busyStatistics->m_dropped > 0);
+    REQUIRE(busyStatistics->m_delivered == busy.load());
+    REQUIRE(RARE == rare.load());
+    REQUIRE(RARE == rareStatistics->m_delivered);
+    REQUIRE(0 == rareStatistics->m_dropped);
+    REQUIRE(rareInOrder.load());
+}
+
+TEST_CASE("Delegate workers deliver the Envelopes of each senderStamp in order.")
+{
+    const uint32_t SENDER_STAMPS{8};
+    const uint32_t ENVELOPES{200};
+
+    std::vector<std::atomic<uint32_t>> last(SENDER_STAMPS);
+    std::atomic<uint32_t> delivered{0};
+    std::atomic<bool> inOrder{true};
+    std::atomic<uint32_t> running{0};
+    std::atomic<uint32_t> maxRunning{0};
+    cluon::OD4Session od4{182,
+                          [&](cluon::data::Envelope &&env) {
+                              const uint32_t NOW_RUNNING{++running};
+                              uint32_t previous{maxRunning.load()};
+                              while ((NOW_RUNNING > previous) && !maxRunning.compare_exchange_weak(previous, NOW_RUNNING)) {}
+                              const uint32_t SENDER_STAMP{env.senderStamp()};
+                              const uint32_t I{static_cast<uint32_t>(cluon::extractMessage<cluon::data::TimeStamp>(std::move(env)).microseconds())};
+                              if (SENDER_STAMP < SENDER_STAMPS)
+                              {
+                                  inOrder = inOrder && (I == last[SENDER_STAMP] + 1);
+                                  last[SENDER_STAMP] = I;
+                              }
+                              std::this_thread::sleep_for(std::chrono::microseconds(100));
+                              delivered++;
+                              running--;
+                          },
+                          4};
+    cluon::OD4Session sender{182};
+    REQUIRE(od4.isRunning());
+
+    for (uint32_t i{1}; i <= ENVELOPES; i++)
+    {
+        for (uint32_t senderStamp{0}; senderStamp < SENDER_STAMPS; senderStamp++)
+        {
+            cluon::data::TimeStamp ts;
+            ts.microseconds(static_cast<int32_t>(i));
+            sender.send(ts, cluon::time::now(), senderStamp);
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(500));
+    }
+    waitUntilDrained(od4);
+
+    uint64_t dropped{0};
+    for (const auto &s : od4.delegateQueueStatistics())
+    {
+        dropped += s.m_dropped;
+    }
+    REQUIRE(0 == dropped);
+    REQUIRE(SENDER_STAMPS * ENVELOPES == delivered.load());
+    REQUIRE(inOrder.load());
+    REQUIRE(maxRunning.load() > 1);
+}
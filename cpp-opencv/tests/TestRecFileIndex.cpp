@@ -0,0 +1,130 @@
+/* Title: Tests for the parallel scan of cluon::RecFileIndex
+ * Authors: Nasit Vurgun, Sam Hardingham, Kai Rowley, Daniel van den Heuvel
+ * Institution: University of Gothenburg, Sweden
+ * Course: DIT638/DIT639 (2024), taught by Prof. Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "catch.hpp"
+#include "cluon-complete.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    std::string envelopeOf(int32_t dataType, const std::string &payload, int32_t seconds)
+    {
+        cluon::data::Envelope env;
+        env.dataType(dataType).serializedData(payload).sampleTimeStamp(cluon::data::TimeStamp{}.seconds(seconds));
+        return cluon::serializeEnvelope(std::move(env));
+    }
+
+    // A payload that contains, every 4 KiB, two complete Envelopes followed by
+    // zeros: a range that starts inside such a payload resynchronizes on the
+    // embedded Envelopes and breaks at the zeros behind them.
+    std::string payloadWithFalseHeaders(std::size_t size)
+    {
+        const std::string EMBEDDED{envelopeOf(1, "embedded", 1) + envelopeOf(1, "embedded", 2)};
+        std::string payload(size, '\0');
+        for (std::size_t i{0}; (i + EMBEDDED.size()) < size; i += 4096)
+        {
+            payload.replace(i, EMBEDDED.size(), EMBEDDED);
+        }
+        return payload;
+    }
+
+    std::vector<cluon::RecFileIndex::Entry> scan(const std::string &file, uint32_t threads, uint64_t &bytesRead)
+    {
+        cluon::MappedRecFile recFile{file};
+        REQUIRE(recFile.valid());
+        return cluon::RecFileIndex::scan(recFile, threads, bytesRead);
+    }
+}
+
+TEST_CASE("Parallel scan of a .rec file with misaligned chunk boundaries equals the sequential scan.")
+{
+    const std::string REC_FILE{"TestRecFileIndex-misaligned.rec"};
+    const uint32_t NUMBER_OF_ENVELOPES{200};
+    {
+        std::fstream out(REC_FILE.c_str(), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+        // The odd-sized first payload shifts all following Envelopes off the chunk boundaries.
+        out << envelopeOf(1000, std::string(777, 'x'), 0);
+        const std::string PAYLOAD{payloadWithFalseHeaders(260 * 1024)};
+        for (uint32_t i{1}; i < NUMBER_OF_ENVELOPES; i++)
+        {
+            out << envelopeOf(1001, PAYLOAD, static_cast<int32_t>(i));
+        }
+    }
+
+    uint64_t sequentialBytesRead{0};
+    const auto SEQUENTIAL{scan(REC_FILE, 1, sequentialBytesRead)};
+    REQUIRE(NUMBER_OF_ENVELOPES == SEQUENTIAL.size());
+
+    for (uint32_t threads : {2u, 3u, 4u, 5u, 8u})
+    {
+        uint64_t parallelBytesRead{0};
+        const auto PARALLEL{scan(REC_FILE, threads, parallelBytesRead)};
+        INFO("threads = " << threads);
+        REQUIRE(SEQUENTIAL.size() == PARALLEL.size());
+        REQUIRE(sequentialBytesRead == parallelBytesRead);
+        for (std::size_t i{0}; i < SEQUENTIAL.size(); i++)
+        {
+            REQUIRE(SEQUENTIAL[i].m_filePosition == PARALLEL[i].m_filePosition);
+            REQUIRE(SEQUENTIAL[i].m_sampleTimeStamp == PARALLEL[i].m_sampleTimeStamp);
+            REQUIRE(SEQUENTIAL[i].m_dataType == PARALLEL[i].m_dataType);
+        }
+    }
+
+    std::remove(REC_FILE.c_str());
+}
+
+TEST_CASE("Repeated parallel scans of a .rec file with many small Envelopes give the same index.")
+{
+    const std::string REC_FILE{"TestRecFileIndex-small.rec"};
+    const uint32_t NUMBER_OF_ENVELOPES{20000};
+    {
+        std::fstream out(REC_FILE.c_str(), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+        for (uint32_t i{0}; i < NUMBER_OF_ENVELOPES; i++)
+        {
+            // About 70 MB, i.e., 8 chunks; payload sizes vary so that the chunk boundaries fall at different offsets into the Envelopes.
+            out << envelopeOf(static_cast<int32_t>(1000 + i % 7), std::string(1 + (i * 37) % 7001, 'x'), static_cast<int32_t>(i));
+        }
+    }
+
+    uint64_t sequentialBytesRead{0};
+    const auto SEQUENTIAL{scan(REC_FILE, 1, sequentialBytesRead)};
+    REQUIRE(NUMBER_OF_ENVELOPES == SEQUENTIAL.size());
+
+    for (uint32_t run{0}; run < 10; run++)
+    {
+        uint64_t parallelBytesRead{0};
+        const auto PARALLEL{scan(REC_FILE, 8, parallelBytesRead)};
+        INFO("run = " << run);
+        REQUIRE(SEQUENTIAL.size() == PARALLEL.size());
+        REQUIRE(sequentialBytesRead == parallelBytesRead);
+        bool equal{true};
+        for (std::size_t i{0}; i < SEQUENTIAL.size(); i++)
+        {
+            equal &= (SEQUENTIAL[i].m_filePosition == PARALLEL[i].m_filePosition) && (SEQUENTIAL[i].m_sampleTimeStamp == PARALLEL[i].m_sampleTimeStamp)
+                     && (SEQUENTIAL[i].m_dataType == PARALLEL[i].m_dataType);
+        }
+        REQUIRE(equal);
+    }
+
+    std::remove(REC_FILE.c_str());
+}
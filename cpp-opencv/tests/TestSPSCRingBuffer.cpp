@@ -0,0 +1,62 @@
+/* Title: Tests for cluon::SPSCRingBuffer with a producer and a consumer thread
+ * Authors: Nasit Vurgun, Sam Hardingham, Kai Rowley, Daniel van den Heuvel
+ * Institution: University of Gothenburg, Sweden
+ * Course: DIT638/DIT639 (2024), taught by Prof. Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "catch.hpp"
+#include "cluon-complete.hpp"
+
+#include <cstdint>
+#include <thread>
+
+TEST_CASE("SPSCRingBuffer passes entries from one producer thread to one consumer thread in order.")
+{
+    const uint64_t ENTRIES{1000000};
+    cluon::SPSCRingBuffer<uint64_t> ring;
+    ring.reset(16);
+    REQUIRE(16 == ring.capacity());
+
+    std::thread producer([&ring, ENTRIES]() {
+        for (uint64_t i{0}; i < ENTRIES; i++)
+        {
+            while (!ring.push(uint64_t{i}))
+            {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    uint64_t expected{0};
+    bool ordered{true};
+    while (expected < ENTRIES)
+    {
+        uint64_t entry{0};
+        if (ring.pop(entry))
+        {
+            ordered &= (expected == entry);
+            expected++;
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+
+    REQUIRE(ordered);
+    REQUIRE(0 == ring.size());
+}
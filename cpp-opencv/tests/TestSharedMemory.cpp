@@ -0,0 +1,197 @@
+/* Title: Tests for the frame sequence numbers and the handshake of cluon::SharedMemory
+ * Authors: Nasit Vurgun, Sam Hardingham, Kai Rowley, Daniel van den Heuvel
+ * Institution: University of Gothenburg, Sweden
+ * Course: DIT638/DIT639 (2024), taught by Prof. Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "catch.hpp"
+#include "cluon-complete.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <thread>
+
+namespace
+{
+    // A frame as the camera writers produce it: the data is written under the lock, the consumers are notified afterwards.
+    void writeFrame(cluon::SharedMemory &sharedMemory, uint64_t value)
+    {
+        sharedMemory.lock();
+        std::memcpy(sharedMemory.data(), &value, sizeof(value));
+        sharedMemory.unlock();
+        sharedMemory.notifyAll();
+    }
+
+    // Writes a frame in another thread and returns true if that took less than timeout.
+    bool writeFrameWithin(cluon::SharedMemory &sharedMemory, uint64_t value, const std::chrono::milliseconds &timeout, const std::function<void()> &meanwhile = nullptr)
+    {
+        std::atomic<bool> written{false};
+        std::thread writer([&sharedMemory, &written, value]() {
+            writeFrame(sharedMemory, value);
+            written = true;
+        });
+        const auto DEADLINE = std::chrono::steady_clock::now() + timeout;
+        while (!written.load() && (std::chrono::steady_clock::now() < DEADLINE))
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        const bool WRITTEN{written.load()};
+        if (meanwhile)
+        {
+            meanwhile();
+        }
+        writer.join();
+        return WRITTEN;
+    }
+}
+
+TEST_CASE("SharedMemory counts frames once whether they are written under the lock or only notified.")
+{
+    cluon::SharedMemory writer{"TestSharedMemory-frames", 1024};
+    cluon::SharedMemory reader{"TestSharedMemory-frames"};
+    REQUIRE(writer.valid());
+    REQUIRE(reader.valid());
+    REQUIRE(reader.hasFrameSequenceNumbers());
+    REQUIRE(0 == reader.frameSequenceNumber());
+
+    // The frame is counted in unlock(), while the writer still holds the lock; notifyAll() does not count it again.
+    writer.lock();
+    writer.unlock();
+    REQUIRE(1 == reader.frameSequenceNumber());
+    writer.notifyAll();
+    REQUIRE(1 == reader.frameSequenceNumber());
+    REQUIRE(0 == reader.skippedFrames());
+
+    writeFrame(writer, 2);
+    writeFrame(writer, 3);
+    writeFrame(writer, 4);
+    REQUIRE(4 == reader.frameSequenceNumber());
+    REQUIRE(2 == reader.skippedFrames());
+    REQUIRE(0 == reader.skippedFrames());
+
+    // Writers that only notify count a frame per notifyAll().
+    writer.notifyAll();
+    writer.notifyAll();
+    REQUIRE(6 == reader.frameSequenceNumber());
+    REQUIRE(1 == reader.skippedFrames());
+
+    // Several locked sections before one notification are several frames.
+    writer.lock();
+    writer.unlock();
+    writer.lock();
+    writer.unlock();
+    writer.notifyAll();
+    REQUIRE(8 == reader.frameSequenceNumber());
+    REQUIRE(1 == reader.skippedFrames());
+}
+
+TEST_CASE("A consumer of SharedMemory reads every frame together with its frame sequence number.")
+{
+    const uint64_t FRAMES{5000};
+    cluon::SharedMemory writer{"TestSharedMemory-sequence", 1024};
+    cluon::SharedMemory reader{"TestSharedMemory-sequence"};
+    REQUIRE(writer.valid());
+    REQUIRE(reader.valid());
+
+    std::thread producer([&writer, FRAMES]() {
+        for (uint64_t i{1}; i <= FRAMES; i++)
+        {
+            writeFrame(writer, i);
+        }
+    });
+
+    uint64_t mismatches{0};
+    uint64_t frames{0};
+    uint64_t last{0};
+    while (last < FRAMES)
+    {
+        if (!reader.waitForFrame(last, std::chrono::seconds(5)))
+        {
+            break;
+        }
+        reader.lock();
+        uint64_t value{0};
+        std::memcpy(&value, reader.data(), sizeof(value));
+        last = reader.frameSequenceNumber();
+        reader.unlock();
+        mismatches += (value == last) ? 0 : 1;
+        frames++;
+    }
+    producer.join();
+
+    INFO(frames << " frames read");
+    REQUIRE(FRAMES == last);
+    REQUIRE(0 == mismatches);
+}
+
+TEST_CASE("In handshake mode, the writer of SharedMemory waits in lock() until the consumer is done with the last frame.")
+{
+    cluon::SharedMemory writer{"TestSharedMemory-handshake", 1024};
+    cluon::SharedMemory reader{"TestSharedMemory-handshake"};
+    REQUIRE(writer.valid());
+    REQUIRE(reader.valid());
+    REQUIRE(reader.setHandshake(true));
+
+    // Nothing is outstanding when the handshake is enabled.
+    REQUIRE(writeFrameWithin(writer, 1, std::chrono::milliseconds(500)));
+    // Frame 1 is not done: the next lock() waits until frameDone(1).
+    REQUIRE(!writeFrameWithin(writer, 2, std::chrono::milliseconds(300), [&reader]() { reader.frameDone(1); }));
+    REQUIRE(2 == reader.frameSequenceNumber());
+    REQUIRE(!reader.handshakeSuspended());
+    reader.frameDone(2);
+    REQUIRE(writeFrameWithin(writer, 3, std::chrono::milliseconds(500)));
+
+    // Without the handshake, the writer does not wait.
+    REQUIRE(reader.setHandshake(false));
+    REQUIRE(writeFrameWithin(writer, 4, std::chrono::milliseconds(500)));
+    REQUIRE(writeFrameWithin(writer, 5, std::chrono::milliseconds(500)));
+}
+
+TEST_CASE("The SharedMemory handshake is suspended after 1 s and resumed when the consumer finishes a newer frame.")
+{
+    cluon::SharedMemory writer{"TestSharedMemory-suspend", 1024};
+    cluon::SharedMemory reader{"TestSharedMemory-suspend"};
+    REQUIRE(writer.valid());
+    REQUIRE(reader.valid());
+    REQUIRE(reader.setHandshake(true));
+    writeFrame(writer, 1);
+    reader.frameDone(1);
+    writeFrame(writer, 2);
+
+    // Frame 2 is not done within 1 s: the writer stops waiting and suspends the handshake.
+    const auto START = std::chrono::steady_clock::now();
+    writeFrame(writer, 3);
+    const auto WAITED = std::chrono::steady_clock::now() - START;
+    REQUIRE(WAITED >= std::chrono::milliseconds(900));
+    REQUIRE(WAITED < std::chrono::milliseconds(3000));
+    REQUIRE(reader.handshakeSuspended());
+
+    // While suspended, the writer does not wait, and finishing a frame that was already done does not resume it.
+    REQUIRE(writeFrameWithin(writer, 4, std::chrono::milliseconds(500)));
+    reader.frameDone(1);
+    REQUIRE(writeFrameWithin(writer, 5, std::chrono::milliseconds(500)));
+    REQUIRE(reader.handshakeSuspended());
+
+    // Finishing a newer frame resumes the handshake with the writer's next lock().
+    reader.frameDone(5);
+    REQUIRE(writeFrameWithin(writer, 6, std::chrono::milliseconds(500)));
+    REQUIRE(!reader.handshakeSuspended());
+    REQUIRE(!writeFrameWithin(writer, 7, std::chrono::milliseconds(300), [&reader]() { reader.frameDone(6); }));
+    REQUIRE(!reader.handshakeSuspended());
+}
@@ -0,0 +1,145 @@
+/* Title: Tests for cluon::SharedMemoryRing with a writer and concurrent readers
+ * Authors: Nasit Vurgun, Sam Hardingham, Kai Rowley, Daniel van den Heuvel
+ * Institution: University of Gothenburg, Sweden
+ * Course: DIT638/DIT639 (2024), taught by Prof. Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "catch.hpp"
+#include "cluon-complete.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    const uint32_t WORDS{1024};
+
+    // The frame bytes are shared without a lock by design; access them word-wise with relaxed
+    // atomics so that ThreadSanitizer checks the ring's own synchronization only.
+    void fill(char *frame, uint64_t value)
+    {
+        uint64_t *words = reinterpret_cast<uint64_t *>(frame);
+        for (uint32_t i{0}; i < WORDS; i++)
+        {
+            __atomic_store_n(&words[i], value, __ATOMIC_RELAXED);
+        }
+    }
+
+    void copy(const char *frame, std::vector<uint64_t> &words)
+    {
+        const uint64_t *source = reinterpret_cast<const uint64_t *>(frame);
+        for (uint32_t i{0}; i < WORDS; i++)
+        {
+            words[i] = __atomic_load_n(&source[i], __ATOMIC_RELAXED);
+        }
+    }
+}
+
+TEST_CASE("Readers of a SharedMemoryRing never accept a frame that was overwritten while being copied.")
+{
+    const uint64_t FRAMES{20000};
+    const uint32_t READERS{3};
+    cluon::SharedMemoryRing writer{"TestSharedMemoryRing", WORDS * sizeof(uint64_t), 3};
+    REQUIRE(writer.valid());
+    REQUIRE(3 == writer.slots());
+
+    std::atomic<uint32_t> attached{0};
+    std::atomic<bool> done{false};
+    std::vector<uint64_t> framesRead(READERS, 0);
+    std::vector<uint64_t> tornFrames(READERS, 0);
+    std::vector<uint64_t> retries(READERS, 0);
+    std::vector<std::thread> readers;
+    for (uint32_t r{0}; r < READERS; r++)
+    {
+        readers.emplace_back([&, r]() {
+            cluon::SharedMemoryRing reader{"TestSharedMemoryRing"};
+            attached++;
+            if (!reader.valid())
+            {
+                return;
+            }
+            std::vector<uint64_t> words(WORDS);
+            uint64_t last{0};
+            while (!done.load() || (reader.frameSequenceNumber() > last))
+            {
+                if (!reader.waitForFrame(last, std::chrono::milliseconds(10)))
+                {
+                    continue;
+                }
+                cluon::data::TimeStamp sampleTime;
+                uint64_t frameSequenceNumber{0};
+                while (true)
+                {
+                    // Catch's assertions are not thread-safe; count the failures and check them in the main thread.
+                    const char *frame = reader.beginRead(frameSequenceNumber, sampleTime);
+                    if (nullptr == frame)
+                    {
+                        tornFrames[r]++;
+                        return;
+                    }
+                    copy(frame, words);
+                    if (reader.endRead())
+                    {
+                        break;
+                    }
+                    retries[r]++;
+                }
+                // A frame accepted by endRead() holds the words of exactly one frame: its own.
+                for (uint32_t i{0}; i < WORDS; i++)
+                {
+                    if (words[i] != frameSequenceNumber)
+                    {
+                        tornFrames[r]++;
+                        break;
+                    }
+                }
+                if ((frameSequenceNumber <= last) || (static_cast<int64_t>(frameSequenceNumber) != cluon::time::toMicroseconds(sampleTime)))
+                {
+                    tornFrames[r]++;
+                }
+                last = frameSequenceNumber;
+                framesRead[r]++;
+            }
+        });
+    }
+    while (READERS > attached.load())
+    {
+        std::this_thread::yield();
+    }
+
+    for (uint64_t i{1}; i <= FRAMES; i++)
+    {
+        char *frame = writer.beginWrite();
+        REQUIRE(nullptr != frame);
+        fill(frame, i);
+        writer.endWrite(cluon::time::fromMicroseconds(static_cast<int64_t>(i)));
+    }
+    done.store(true);
+    for (auto &reader : readers)
+    {
+        reader.join();
+    }
+
+    REQUIRE(FRAMES == writer.frameSequenceNumber());
+    for (uint32_t r{0}; r < READERS; r++)
+    {
+        INFO("reader " << r << ": " << framesRead[r] << " frames read, " << retries[r] << " retried");
+        REQUIRE(0 < framesRead[r]);
+        REQUIRE(0 == tornFrames[r]);
+    }
+}